@@ -0,0 +1,382 @@
+#include "advice_server.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+#include "montecarlo.h"
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+namespace {
+
+// Wakes the I/O loop to check for stop() even when no client is active.
+const int kAdvicePollTimeoutMs = 100;
+const std::size_t kAdviceReadSize = 4096;
+// A connection is not read while it holds a batch of unanswered requests or this many
+// unsent response bytes, so a client that floods or never reads only fills its own socket.
+const std::size_t kAdviceMaxInputSize = kAdviceMaxBatchSize * sizeof(AdviceRequest);
+const std::size_t kAdviceMaxOutputSize = 4 * kAdviceMaxBatchSize * sizeof(AdviceResponse);
+
+}
+
+AdviceServer::AdviceServer(const IBoardEvaluator* evaluator, int threadCount) : listener(-1),
+	evaluator(evaluator), threadCount(std::max(1, threadCount)), batchGeneration(0),
+	nextEntry(0), activeWorkers(0), isStopping(false), servedCount(0) {
+	for (int i = 0; i < this->threadCount; i++) {
+		workers.emplace_back(&AdviceServer::workerLoop, this);
+	}
+}
+
+AdviceServer::~AdviceServer() {
+	isStopping = true;
+	batchGeneration.fetch_add(1);
+	batchGeneration.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+#ifndef _WIN32
+	for (auto& connection : connections) {
+		::close(connection.socket);
+	}
+	if (listener >= 0) {
+		::close(listener);
+		unlink(socketPath.c_str());
+	}
+#endif
+}
+
+void AdviceServer::workerLoop() {
+	ExpectimaxSearch search;
+	MonteCarloPolicy monteCarlo;
+	search.setEvaluator(evaluator);
+	unsigned int generation = 0;
+	while (true) {
+		batchGeneration.wait(generation, std::memory_order_acquire);
+		generation = batchGeneration.load(std::memory_order_acquire);
+		if (isStopping) {
+			break;
+		}
+		// every worker checks in once per batch, so none of them touches the batch after it is done
+		for (int i = nextEntry.fetch_add(1); i < (int)uniqueEntries.size(); i = nextEntry.fetch_add(1)) {
+			const AdviceRequest& request = batch[uniqueEntries[i]].request;
+			SearchResult result;
+			if ((AIPolicy)request.policy == AIPolicy::MonteCarlo) {
+				result = monteCarlo.findBestMove(request.board);
+			}
+			else {
+				result = search.findBestMove(request.board, request.depth);
+			}
+			responses[uniqueEntries[i]] = AdviceResponse{
+				.id = request.id,
+				.movement = (std::uint8_t)result.bestMovement,
+				.reserved = {},
+				.value = result.value,
+				.nodeCount = (std::uint32_t)std::min<long long>(result.nodeCount, UINT32_MAX),
+			};
+		}
+		if (activeWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			activeWorkers.notify_one();
+		}
+	}
+}
+
+void AdviceServer::evaluateBatch() {
+	if (batch.empty()) {
+		return;
+	}
+	// clients polling the same position (e.g. several game windows) share one search
+	std::unordered_map<PackedBoard, int> firstEntries;
+	uniqueEntries.clear();
+	for (int i = 0; i < (int)batch.size(); i++) {
+		const AdviceRequest& request = batch[i].request;
+		auto first = firstEntries.find(request.board);
+		if (first != firstEntries.end() && batch[first->second].request.policy == request.policy &&
+		    batch[first->second].request.depth == request.depth) {
+			batch[i].source = first->second;
+			continue;
+		}
+		firstEntries[request.board] = i;
+		batch[i].source = i;
+		uniqueEntries.push_back(i);
+	}
+	responses.resize(batch.size());
+
+	nextEntry.store(0, std::memory_order_relaxed);
+	activeWorkers.store(threadCount, std::memory_order_relaxed);
+	batchGeneration.fetch_add(1, std::memory_order_release);
+	batchGeneration.notify_all();
+	for (int active = activeWorkers.load(std::memory_order_acquire); active != 0;
+	     active = activeWorkers.load(std::memory_order_acquire)) {
+		activeWorkers.wait(active, std::memory_order_acquire);
+	}
+
+	for (int i = 0; i < (int)batch.size(); i++) {
+		AdviceResponse response = responses[batch[i].source];
+		response.id = batch[i].request.id;
+		Connection& connection = connections[batch[i].connection];
+		if (connection.socket < 0) {
+			continue;
+		}
+		const std::uint8_t* bytes = (const std::uint8_t*)&response;
+		connection.output.insert(connection.output.end(), bytes, bytes + sizeof(response));
+	}
+	servedCount += (long long)batch.size();
+	batch.clear();
+}
+
+#ifndef _WIN32
+
+bool AdviceServer::open(const std::string& path) {
+	sockaddr_un address{};
+	if (path.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+	listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0) {
+		return false;
+	}
+	unlink(path.c_str());
+	if (bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+		::close(listener);
+		listener = -1;
+		return false;
+	}
+	fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+	socketPath = path;
+	return true;
+}
+
+void AdviceServer::acceptConnections() {
+	while (true) {
+		int clientSocket = accept(listener, nullptr, nullptr);
+		if (clientSocket < 0) {
+			return;
+		}
+		fcntl(clientSocket, F_SETFL, fcntl(clientSocket, F_GETFL) | O_NONBLOCK);
+		connections.push_back(Connection{ .socket = clientSocket, .input = {}, .output = {}, .isReadClosed = false });
+	}
+}
+
+bool AdviceServer::readRequests(int connection) {
+	std::vector<std::uint8_t>& input = connections[connection].input;
+	while (input.size() < kAdviceMaxInputSize) {
+		std::size_t oldSize = input.size();
+		std::size_t size = std::min(kAdviceReadSize, kAdviceMaxInputSize - oldSize);
+		input.resize(oldSize + size);
+		ssize_t readSize = recv(connections[connection].socket, input.data() + oldSize, size, 0);
+		input.resize(oldSize + std::max<ssize_t>(readSize, 0));
+		if (readSize == 0) {
+			connections[connection].isReadClosed = true;
+			return true;
+		}
+		if (readSize < 0) {
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+		}
+	}
+	return true;
+}
+
+bool AdviceServer::writeResponses(Connection& connection) {
+	std::size_t writtenSize = 0;
+	while (writtenSize < connection.output.size()) {
+		ssize_t sentSize = send(connection.socket, connection.output.data() + writtenSize,
+		                        connection.output.size() - writtenSize, MSG_NOSIGNAL);
+		if (sentSize < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+				break;
+			}
+			return false;
+		}
+		writtenSize += (std::size_t)sentSize;
+	}
+	connection.output.erase(connection.output.begin(), connection.output.begin() + writtenSize);
+	return true;
+}
+
+bool AdviceServer::run() {
+	if (listener < 0) {
+		return false;
+	}
+	std::vector<pollfd> pollSockets;
+	bool hasBufferedRequests = false;
+	while (!isStopping) {
+		pollSockets.clear();
+		pollSockets.push_back(pollfd{ .fd = listener, .events = POLLIN, .revents = 0 });
+		for (auto& connection : connections) {
+			bool isReadable = !connection.isReadClosed && connection.input.size() < kAdviceMaxInputSize &&
+			                  connection.output.size() < kAdviceMaxOutputSize;
+			short events = (isReadable ? POLLIN : 0) | (connection.output.empty() ? 0 : POLLOUT);
+			pollSockets.push_back(pollfd{ .fd = connection.socket, .events = events, .revents = 0 });
+		}
+		// requests left over from a full batch must not wait for new input
+		int timeout = hasBufferedRequests ? 0 : kAdvicePollTimeoutMs;
+		if (poll(pollSockets.data(), pollSockets.size(), timeout) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+
+		for (std::size_t i = 1; i < pollSockets.size(); i++) {
+			Connection& connection = connections[i - 1];
+			bool isOpen = true;
+			if (!connection.isReadClosed && (pollSockets[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+				isOpen = readRequests((int)i - 1);
+			}
+			if (!isOpen) {
+				::close(connection.socket);
+				connection.socket = -1;
+			}
+		}
+		if (pollSockets[0].revents & POLLIN) {
+			acceptConnections();
+		}
+
+		// whole records only, a partial one stays in the buffer until the rest arrives
+		hasBufferedRequests = false;
+		for (int i = 0; i < (int)connections.size(); i++) {
+			std::vector<std::uint8_t>& input = connections[i].input;
+			std::size_t offset = 0;
+			while (connections[i].socket >= 0 && connections[i].output.size() < kAdviceMaxOutputSize &&
+			       input.size() - offset >= sizeof(AdviceRequest)) {
+				if (batch.size() >= (std::size_t)kAdviceMaxBatchSize) {
+					hasBufferedRequests = true;
+					break;
+				}
+				AdviceRequest request;
+				std::memcpy(&request, input.data() + offset, sizeof(request));
+				offset += sizeof(request);
+				int depth = request.depth == 0 ? kDefaultSearchDepth : request.depth;
+				request.depth = (std::uint8_t)std::min(depth, kAdviceMaxDepth);
+				batch.push_back(BatchEntry{ .request = request, .connection = i, .source = i });
+			}
+			input.erase(input.begin(), input.begin() + offset);
+		}
+		evaluateBatch();
+
+		for (auto& connection : connections) {
+			if (connection.socket < 0) {
+				continue;
+			}
+			// a partial record left by a half-closed client can never be completed
+			bool isDone = connection.isReadClosed && connection.input.size() < sizeof(AdviceRequest);
+			if (!writeResponses(connection) || (isDone && connection.output.empty())) {
+				::close(connection.socket);
+				connection.socket = -1;
+			}
+		}
+		std::erase_if(connections, [](const Connection& connection) { return connection.socket < 0; });
+	}
+	return true;
+}
+
+AdviceClient::AdviceClient() : socket(-1) {
+}
+
+AdviceClient::~AdviceClient() {
+	close();
+}
+
+bool AdviceClient::connect(const std::string& path) {
+	close();
+	sockaddr_un address{};
+	if (path.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+	socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socket < 0) {
+		return false;
+	}
+	if (::connect(socket, (const sockaddr*)&address, sizeof(address)) != 0) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void AdviceClient::close() {
+	if (socket >= 0) {
+		::close(socket);
+		socket = -1;
+	}
+}
+
+bool AdviceClient::requestMoves(const AdviceRequest* requests, AdviceResponse* responses, int count) {
+	if (socket < 0) {
+		return false;
+	}
+	std::size_t requestSize = sizeof(AdviceRequest) * count;
+	for (std::size_t sentSize = 0; sentSize < requestSize;) {
+		ssize_t size = send(socket, (const std::uint8_t*)requests + sentSize, requestSize - sentSize, MSG_NOSIGNAL);
+		if (size <= 0) {
+			return false;
+		}
+		sentSize += (std::size_t)size;
+	}
+	std::size_t responseSize = sizeof(AdviceResponse) * count;
+	for (std::size_t receivedSize = 0; receivedSize < responseSize;) {
+		ssize_t size = recv(socket, (std::uint8_t*)responses + receivedSize, responseSize - receivedSize, 0);
+		if (size <= 0) {
+			return false;
+		}
+		receivedSize += (std::size_t)size;
+	}
+	return true;
+}
+
+#else
+
+bool AdviceServer::open(const std::string&) {
+	return false;
+}
+
+void AdviceServer::acceptConnections() {
+}
+
+bool AdviceServer::readRequests(int) {
+	return false;
+}
+
+bool AdviceServer::writeResponses(Connection&) {
+	return false;
+}
+
+bool AdviceServer::run() {
+	return false;
+}
+
+AdviceClient::AdviceClient() : socket(-1) {
+}
+
+AdviceClient::~AdviceClient() {
+}
+
+bool AdviceClient::connect(const std::string&) {
+	return false;
+}
+
+void AdviceClient::close() {
+}
+
+bool AdviceClient::requestMoves(const AdviceRequest*, AdviceResponse*, int) {
+	return false;
+}
+
+#endif
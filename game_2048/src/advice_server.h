@@ -0,0 +1,135 @@
+#ifndef GAME_2048_ADVICE_SERVER_H
+#define GAME_2048_ADVICE_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "search.h"
+
+/*
+	Binary protocol of the advice server. Both records are 16 bytes in the host byte order,
+	the socket is local, so both sides always share it:
+	 - request: id, AIPolicy, depth (0 - server default), board packed by GameField::getBoard();
+	 - response: id of the request, best movement (None if there is no move), value, node count.
+	A client may send any number of requests without waiting, every response carries the id
+	of its request.
+*/
+struct AdviceRequest {
+	std::uint32_t id;
+	std::uint8_t policy;
+	std::uint8_t depth;
+	std::uint16_t reserved;
+	std::uint64_t board;
+};
+
+struct AdviceResponse {
+	std::uint32_t id;
+	std::uint8_t movement;
+	std::uint8_t reserved[3];
+	float value;
+	std::uint32_t nodeCount;
+};
+
+static_assert(sizeof(AdviceRequest) == 16 && sizeof(AdviceResponse) == 16, "Advice records must be 16 bytes");
+
+const char* const kAdviceSocketPath = "/tmp/game_2048_advisor.sock";
+const int kAdviceMaxDepth = 6;
+const int kAdviceMaxBatchSize = 256;
+
+/*
+	Answers best move requests on a Unix domain socket:
+	 - one I/O thread polls all connections and collects every complete request into a batch;
+	 - equal requests in a batch are evaluated only once;
+	 - the batch is spread over the worker threads, requests arriving meanwhile form the next batch;
+	 - a connection with a batch of requests or a few batches of responses pending is not read
+	   until they are handled, so the memory of a client that floods or never reads stays bounded;
+	 - a client may shut down its sending side after the last request and read until the end
+	   of the stream, every whole request is answered before the server closes the connection.
+	Linux and other POSIX systems only, open() fails elsewhere.
+*/
+class AdviceServer {
+private:
+	struct Connection {
+		int socket;
+		std::vector<std::uint8_t> input;
+		std::vector<std::uint8_t> output;
+		// the client shut down its sending side, the connection closes once its requests are answered
+		bool isReadClosed;
+	};
+
+	struct BatchEntry {
+		AdviceRequest request;
+		int connection;
+		// index of the entry with the same request that is actually evaluated
+		int source;
+	};
+
+	int listener;
+	std::string socketPath;
+	std::vector<Connection> connections;
+
+	const IBoardEvaluator* evaluator;
+	int threadCount;
+
+	std::vector<BatchEntry> batch;
+	std::vector<int> uniqueEntries;
+	std::vector<AdviceResponse> responses;
+
+	// Incremented with every batch, idle workers sleep on it.
+	std::atomic<unsigned int> batchGeneration;
+	std::atomic<int> nextEntry;
+	std::atomic<int> activeWorkers;
+	std::atomic<bool> isStopping;
+
+	std::vector<std::thread> workers;
+
+	long long servedCount;
+
+	void workerLoop();
+	void acceptConnections();
+	// Returns false if the connection is broken.
+	bool readRequests(int connection);
+	bool writeResponses(Connection& connection);
+	void evaluateBatch();
+
+public:
+	// nullptr evaluator means evaluateBoard(). The evaluator must outlive the server.
+	AdviceServer(const IBoardEvaluator* evaluator, int threadCount);
+	~AdviceServer();
+
+	AdviceServer(const AdviceServer&) = delete;
+	AdviceServer& operator=(const AdviceServer&) = delete;
+
+	// Replaces a stale socket file left by a previous run.
+	bool open(const std::string& path);
+	// Serves until stop() is called, returns false on a socket error.
+	bool run();
+	// Safe to call from a signal handler.
+	void stop() { isStopping = true; }
+	long long getServedCount() const { return servedCount; }
+};
+
+// Blocking client of AdviceServer, for tools and other game instances.
+class AdviceClient {
+private:
+	int socket;
+
+public:
+	AdviceClient();
+	~AdviceClient();
+
+	AdviceClient(const AdviceClient&) = delete;
+	AdviceClient& operator=(const AdviceClient&) = delete;
+
+	bool connect(const std::string& path);
+	void close();
+	bool isConnected() const { return socket >= 0; }
+
+	// Sends all requests first and then collects the responses in the request order.
+	bool requestMoves(const AdviceRequest* requests, AdviceResponse* responses, int count);
+};
+
+#endif // GAME_2048_ADVICE_SERVER_H
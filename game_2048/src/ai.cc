@@ -0,0 +1,101 @@
+#include "ai.h"
+
+#include <chrono>
+
+MoveAdvisor::MoveAdvisor() : pushedResultCount(0), waitedResultCount(0), requestGeneration(0),
+	isStopping(false), policy(AIPolicy::Expectimax), evaluator(nullptr), openingBook(nullptr), thinkTime(0),
+	searchDepth(kDefaultSearchDepth) {
+	worker = std::thread(&MoveAdvisor::workerLoop, this);
+}
+
+MoveAdvisor::~MoveAdvisor() {
+	isStopping = true;
+	requestGeneration.fetch_add(1);
+	requestGeneration.notify_one();
+	worker.join();
+}
+
+bool MoveAdvisor::requestMove(PackedBoard board) {
+	if (!requests.tryPush(board)) {
+		return false;
+	}
+	requestGeneration.fetch_add(1, std::memory_order_release);
+	requestGeneration.notify_one();
+	return true;
+}
+
+bool MoveAdvisor::pollMove(MoveAdvice& advice) {
+	return results.tryPop(advice);
+}
+
+bool MoveAdvisor::waitForMove(std::chrono::steady_clock::duration timeout) {
+	std::unique_lock<std::mutex> lock(resultMutex);
+	bool isPushed = resultReady.wait_for(lock, timeout, [this] {
+		return pushedResultCount.load(std::memory_order_acquire) != waitedResultCount;
+	});
+	waitedResultCount = pushedResultCount.load(std::memory_order_acquire);
+	return isPushed;
+}
+
+void MoveAdvisor::workerLoop() {
+	ExpectimaxSearch search;
+	MonteCarloPolicy monteCarlo;
+	PackedBoard board = 0;
+	bool hasBoard = false;
+	while (!isStopping) {
+		unsigned int generation = requestGeneration.load(std::memory_order_acquire);
+		// only the newest snapshot is worth searching
+		PackedBoard newBoard;
+		while (requests.tryPop(newBoard)) {
+			board = newBoard;
+			hasBoard = true;
+		}
+		if (!hasBoard) {
+			requestGeneration.wait(generation, std::memory_order_acquire);
+			continue;
+		}
+		auto stopCondition = [this, generation] {
+			return requestGeneration.load(std::memory_order_relaxed) != generation;
+		};
+		SearchResult result;
+		const OpeningBook* book = openingBook;
+		if (book != nullptr && book->lookup(board, result.bestMovement, result.value)) {
+			result.nodeCount = 0;
+			result.depth = 0;
+			result.isAborted = false;
+		}
+		else if (policy == AIPolicy::MonteCarlo) {
+			monteCarlo.setStopCondition(stopCondition);
+			result = monteCarlo.findBestMove(board);
+		}
+		else {
+			search.setStopCondition(stopCondition);
+			search.setEvaluator(evaluator);
+			int milliseconds = thinkTime;
+			result = milliseconds > 0 ?
+				search.searchUntil(board, std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds),
+				                   kAdvisorMaxDepth) :
+				search.findBestMove(board, searchDepth);
+		}
+		if (result.isAborted) {
+			continue;
+		}
+		hasBoard = false;
+		MoveAdvice advice{
+			.board = board,
+			.movement = result.bestMovement,
+			.value = result.value,
+			.nodeCount = result.nodeCount,
+			.depth = result.depth,
+		};
+		// the UI drains results every frame, so a full channel only means a stale backlog
+		if (results.tryPush(advice)) {
+			{
+				// the waiter checks the count under the mutex, so the notification can't fall between
+				std::lock_guard<std::mutex> lock(resultMutex);
+				pushedResultCount.fetch_add(1, std::memory_order_release);
+			}
+			resultReady.notify_one();
+		}
+	}
+}
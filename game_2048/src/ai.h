@@ -0,0 +1,86 @@
+#ifndef GAME_2048_AI_H
+#define GAME_2048_AI_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "channel.h"
+#include "search.h"
+#include "montecarlo.h"
+#include "opening_book.h"
+
+// Deepest search of a move advised under a think time.
+const int kAdvisorMaxDepth = 8;
+
+struct MoveAdvice {
+	PackedBoard board;
+	UserMovement movement;
+	float value;
+	long long nodeCount;
+	int depth; // of the expectimax search, 0 - book or Monte Carlo
+};
+
+/*
+	Searches for the best move on a background thread:
+	 - requestMove() posts a board snapshot and cancels the search of any older snapshot;
+	 - pollMove() returns finished advice without ever blocking;
+	 - waitForMove() lets a caller with nothing else to do sleep until advice arrives.
+	These methods must be called from the same (UI) thread.
+*/
+class MoveAdvisor {
+private:
+	SpscChannel<PackedBoard, 16> requests;
+	SpscChannel<MoveAdvice, 16> results;
+	// Results pushed by the worker, and their count when the last waitForMove() returned:
+	// a result the UI thread never pops (autoplay turned off) must not wake every later wait.
+	std::atomic<unsigned int> pushedResultCount;
+	unsigned int waitedResultCount;
+	std::mutex resultMutex;
+	std::condition_variable resultReady;
+
+	// Incremented with every posted request, the worker sleeps on it while idle
+	// and aborts the current search as soon as it changes.
+	std::atomic<unsigned int> requestGeneration;
+	std::atomic<bool> isStopping;
+	std::atomic<AIPolicy> policy;
+	std::atomic<const IBoardEvaluator*> evaluator;
+	std::atomic<const OpeningBook*> openingBook;
+	std::atomic<int> thinkTime;
+
+	int searchDepth;
+
+	std::thread worker;
+
+	void workerLoop();
+
+public:
+	MoveAdvisor();
+	~MoveAdvisor();
+
+	MoveAdvisor(const MoveAdvisor&) = delete;
+	MoveAdvisor& operator=(const MoveAdvisor&) = delete;
+
+	// Returns false if the request queue is full, try again on the next frame.
+	bool requestMove(PackedBoard board);
+	bool pollMove(MoveAdvice& advice);
+	// Blocks until a result is pushed after the previous wait or the timeout passes,
+	// returns false on timeout.
+	bool waitForMove(std::chrono::steady_clock::duration timeout);
+
+	// Applies to the searches started after this call.
+	void setPolicy(AIPolicy newPolicy) { policy = newPolicy; }
+	// Leaf evaluation of the expectimax policy, nullptr - built-in heuristic.
+	// The evaluator must outlive the advisor.
+	void setEvaluator(const IBoardEvaluator* newEvaluator) { evaluator = newEvaluator; }
+	// Positions found in the book are answered without a search, nullptr - no book.
+	// The book must outlive the advisor.
+	void setOpeningBook(const OpeningBook* newOpeningBook) { openingBook = newOpeningBook; }
+	// Milliseconds for which an expectimax search keeps deepening (up to kAdvisorMaxDepth),
+	// 0 - always search kDefaultSearchDepth.
+	void setThinkTime(int milliseconds) { thinkTime = milliseconds; }
+};
+
+#endif // GAME_2048_AI_H
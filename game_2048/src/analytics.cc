@@ -0,0 +1,242 @@
+#include "analytics.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include "symmetry.h"
+
+/*
+	Summary file layout (little-endian):
+	 - "2048STAT", u32 version;
+	 - u8 HyperLogLog registers[2^14];
+	 - u64 total count, u32 count-min counters[4 * 2^16];
+	 - u32 heavy hitter count, (u64 board, u32 count) entries;
+	 - u64 game count, u64 max tile histogram[16], u64 score histogram[32].
+*/
+const char kAnalyticsFileMagic[8] = { '2', '0', '4', '8', 'S', 'T', 'A', 'T' };
+const std::uint32_t kAnalyticsFileVersion = 1;
+
+namespace {
+
+template <typename T>
+void writeValue(std::ofstream& file, const T& value) {
+	file.write((const char*)&value, sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::ifstream& file, T& value) {
+	return (bool)file.read((char*)&value, sizeof(T));
+}
+
+template <typename T>
+void writeArray(std::ofstream& file, const std::vector<T>& values) {
+	file.write((const char*)values.data(), values.size() * sizeof(T));
+}
+
+template <typename T>
+bool readArray(std::ifstream& file, std::vector<T>& values) {
+	return (bool)file.read((char*)values.data(), values.size() * sizeof(T));
+}
+
+}
+
+HyperLogLog::HyperLogLog() : registers(kRegisterCount, 0) {}
+
+void HyperLogLog::add(std::uint64_t hash) {
+	std::size_t index = hash >> (64 - kPrecision);
+	// the rest of the bits with a stop bit, so the rank is at most 64 - kPrecision + 1
+	std::uint64_t rest = (hash << kPrecision) | (1ULL << (kPrecision - 1));
+	std::uint8_t rank = (std::uint8_t)(std::countl_zero(rest) + 1);
+	registers[index] = std::max(registers[index], rank);
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+	for (int i = 0; i < kRegisterCount; i++) {
+		registers[i] = std::max(registers[i], other.registers[i]);
+	}
+}
+
+double HyperLogLog::estimate() const {
+	double sum = 0;
+	int zeroCount = 0;
+	for (std::uint8_t rank : registers) {
+		sum += std::ldexp(1.0, -rank);
+		zeroCount += rank == 0 ? 1 : 0;
+	}
+	double alpha = 0.7213 / (1.0 + 1.079 / kRegisterCount);
+	double estimate = alpha * kRegisterCount * kRegisterCount / sum;
+	// linear counting is more precise while many registers are still empty
+	if (estimate <= 2.5 * kRegisterCount && zeroCount != 0) {
+		return kRegisterCount * std::log((double)kRegisterCount / zeroCount);
+	}
+	return estimate;
+}
+
+CountMinSketch::CountMinSketch() : counters(kDepth * kWidth, 0), totalCount(0) {}
+
+// Rows use h1 + row * h2 (Kirsch-Mitzenmacher), both halves of one 64 bit hash.
+std::size_t CountMinSketch::getIndex(std::uint64_t hash, int row) {
+	std::uint32_t h1 = (std::uint32_t)hash;
+	std::uint32_t h2 = (std::uint32_t)(hash >> 32) | 1;
+	return (std::size_t)row * kWidth + ((h1 + (std::uint32_t)row * h2) & (kWidth - 1));
+}
+
+void CountMinSketch::add(std::uint64_t hash, std::uint32_t count) {
+	for (int row = 0; row < kDepth; row++) {
+		std::uint32_t& counter = counters[getIndex(hash, row)];
+		counter = counter > UINT32_MAX - count ? UINT32_MAX : counter + count;
+	}
+	totalCount += count;
+}
+
+std::uint32_t CountMinSketch::estimate(std::uint64_t hash) const {
+	std::uint32_t minimum = UINT32_MAX;
+	for (int row = 0; row < kDepth; row++) {
+		minimum = std::min(minimum, counters[getIndex(hash, row)]);
+	}
+	return minimum;
+}
+
+void CountMinSketch::merge(const CountMinSketch& other) {
+	for (std::size_t i = 0; i < counters.size(); i++) {
+		std::uint32_t count = other.counters[i];
+		counters[i] = counters[i] > UINT32_MAX - count ? UINT32_MAX : counters[i] + count;
+	}
+	totalCount += other.totalCount;
+}
+
+BoardAnalytics::BoardAnalytics() : gameCount(0), maxTileHistogram(kMaxTileBuckets, 0),
+	scoreHistogram(kScoreBuckets, 0) {
+	heavyHitters.reserve(kHeavyHitterCount + 1);
+}
+
+void BoardAnalytics::addBoard(PackedBoard board) {
+	PackedBoard canonical = canonicalizeBoard(board).board;
+	std::uint64_t hash = hashBoard(canonical);
+	distinctBoards.add(hash);
+	boardCounts.add(hash);
+	updateHeavyHitter(canonical, boardCounts.estimate(hash));
+}
+
+void BoardAnalytics::updateHeavyHitter(PackedBoard board, std::uint32_t count) {
+	// most boards are rare, they are rejected without looking at the candidates
+	if (heavyHitters.size() == kHeavyHitterCount && count <= heavyHitters.back().count) {
+		return;
+	}
+	auto entry = std::find_if(heavyHitters.begin(), heavyHitters.end(),
+	                          [board](const BoardFrequency& frequency) { return frequency.board == board; });
+	if (entry == heavyHitters.end()) {
+		heavyHitters.push_back(BoardFrequency{ .board = board, .count = count });
+		entry = heavyHitters.end() - 1;
+	}
+	entry->count = count;
+	// kept sorted, so the smallest candidate is always the last one; estimates
+	// only grow, so an entry only moves towards the front
+	for (auto i = entry - heavyHitters.begin(); i > 0 && heavyHitters[i].count > heavyHitters[i - 1].count; i--) {
+		std::swap(heavyHitters[i], heavyHitters[i - 1]);
+	}
+	if (heavyHitters.size() > kHeavyHitterCount) {
+		heavyHitters.pop_back();
+	}
+}
+
+void BoardAnalytics::addGame(GameTileType maxTile, int score) {
+	gameCount++;
+	maxTileHistogram[std::clamp((int)maxTile, 0, kMaxTileBuckets - 1)]++;
+	int scoreBucket = score <= 0 ? 0 : (int)std::bit_width((unsigned int)score);
+	scoreHistogram[std::min(scoreBucket, kScoreBuckets - 1)]++;
+}
+
+void BoardAnalytics::merge(const BoardAnalytics& other) {
+	distinctBoards.merge(other.distinctBoards);
+	boardCounts.merge(other.boardCounts);
+	gameCount += other.gameCount;
+	for (int i = 0; i < kMaxTileBuckets; i++) {
+		maxTileHistogram[i] += other.maxTileHistogram[i];
+	}
+	for (int i = 0; i < kScoreBuckets; i++) {
+		scoreHistogram[i] += other.scoreHistogram[i];
+	}
+	// candidates of both sides are estimated again with the merged sketch
+	std::vector<BoardFrequency> candidates = heavyHitters;
+	for (const auto& frequency : other.heavyHitters) {
+		bool isKnown = std::any_of(candidates.begin(), candidates.end(),
+		                           [&](const BoardFrequency& known) { return known.board == frequency.board; });
+		if (!isKnown) {
+			candidates.push_back(frequency);
+		}
+	}
+	for (auto& candidate : candidates) {
+		candidate.count = boardCounts.estimate(hashBoard(candidate.board));
+	}
+	std::stable_sort(candidates.begin(), candidates.end(), [](const BoardFrequency& a, const BoardFrequency& b) {
+		return a.count > b.count;
+	});
+	if (candidates.size() > kHeavyHitterCount) {
+		candidates.resize(kHeavyHitterCount);
+	}
+	heavyHitters = candidates;
+}
+
+std::vector<BoardFrequency> BoardAnalytics::getHeavyHitters() const {
+	return heavyHitters;
+}
+
+bool BoardAnalytics::save(const std::string& path) const {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	file.write(kAnalyticsFileMagic, sizeof(kAnalyticsFileMagic));
+	writeValue(file, kAnalyticsFileVersion);
+	writeArray(file, distinctBoards.getRegisters());
+	writeValue(file, boardCounts.getTotalCount());
+	writeArray(file, boardCounts.getCounters());
+	writeValue(file, (std::uint32_t)heavyHitters.size());
+	for (const auto& frequency : heavyHitters) {
+		writeValue(file, frequency.board);
+		writeValue(file, frequency.count);
+	}
+	writeValue(file, gameCount);
+	writeArray(file, maxTileHistogram);
+	writeArray(file, scoreHistogram);
+	return (bool)file;
+}
+
+bool BoardAnalytics::load(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	char magic[sizeof(kAnalyticsFileMagic)];
+	std::uint32_t version = 0;
+	if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, kAnalyticsFileMagic, sizeof(magic)) != 0 ||
+	    !readValue(file, version) || version != kAnalyticsFileVersion) {
+		return false;
+	}
+	BoardAnalytics loaded;
+	std::uint64_t totalCount = 0;
+	std::uint32_t heavyHitterCount = 0;
+	if (!readArray(file, loaded.distinctBoards.getRegisters()) || !readValue(file, totalCount) ||
+	    !readArray(file, loaded.boardCounts.getCounters()) || !readValue(file, heavyHitterCount) ||
+	    heavyHitterCount > kHeavyHitterCount) {
+		return false;
+	}
+	loaded.boardCounts.setTotalCount(totalCount);
+	for (std::uint32_t i = 0; i < heavyHitterCount; i++) {
+		BoardFrequency frequency{};
+		if (!readValue(file, frequency.board) || !readValue(file, frequency.count)) {
+			return false;
+		}
+		loaded.heavyHitters.push_back(frequency);
+	}
+	if (!readValue(file, loaded.gameCount) || !readArray(file, loaded.maxTileHistogram) ||
+	    !readArray(file, loaded.scoreHistogram)) {
+		return false;
+	}
+	*this = std::move(loaded);
+	return true;
+}
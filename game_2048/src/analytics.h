@@ -0,0 +1,106 @@
+#ifndef GAME_2048_ANALYTICS_H
+#define GAME_2048_ANALYTICS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.h"
+
+/*
+	Bounded memory summaries of boards seen in self-play. Every summary can be
+	merged with another one of the same size, so threads keep their own copies
+	and runs are combined through saved files.
+*/
+
+// Count of distinct hashes with ~0.8% standard error (2^14 registers).
+class HyperLogLog {
+private:
+	static const int kPrecision = 14;
+	static const int kRegisterCount = 1 << kPrecision;
+
+	std::vector<std::uint8_t> registers;
+
+public:
+	HyperLogLog();
+
+	void add(std::uint64_t hash);
+	void merge(const HyperLogLog& other);
+	double estimate() const;
+
+	const std::vector<std::uint8_t>& getRegisters() const { return registers; }
+	std::vector<std::uint8_t>& getRegisters() { return registers; }
+};
+
+// Upper bound of the count of every hash, overestimates by at most ~e / width of the total.
+class CountMinSketch {
+private:
+	static const int kDepth = 4;
+	static const int kWidth = 1 << 16;
+
+	std::vector<std::uint32_t> counters;
+	std::uint64_t totalCount;
+
+	static std::size_t getIndex(std::uint64_t hash, int row);
+
+public:
+	CountMinSketch();
+
+	void add(std::uint64_t hash, std::uint32_t count = 1);
+	std::uint32_t estimate(std::uint64_t hash) const;
+	void merge(const CountMinSketch& other);
+	std::uint64_t getTotalCount() const { return totalCount; }
+
+	const std::vector<std::uint32_t>& getCounters() const { return counters; }
+	std::vector<std::uint32_t>& getCounters() { return counters; }
+	void setTotalCount(std::uint64_t count) { totalCount = count; }
+};
+
+struct BoardFrequency {
+	PackedBoard board;
+	std::uint32_t count;
+};
+
+/*
+	Everything the analytics tool collects:
+	 - boards are counted by their canonical form, so symmetric boards are one board;
+	 - the most frequent boards are the candidates with the largest sketch estimates,
+	   a board enters the candidates once its estimate beats the smallest one.
+*/
+class BoardAnalytics {
+private:
+	HyperLogLog distinctBoards;
+	CountMinSketch boardCounts;
+	std::vector<BoardFrequency> heavyHitters;
+
+	std::uint64_t gameCount;
+	std::vector<std::uint64_t> maxTileHistogram;
+	std::vector<std::uint64_t> scoreHistogram;
+
+	void updateHeavyHitter(PackedBoard board, std::uint32_t count);
+
+public:
+	static const int kHeavyHitterCount = 64;
+	static const int kMaxTileBuckets = 16;
+	// bucket i counts scores in [2^(i-1); 2^i), bucket 0 - zero score
+	static const int kScoreBuckets = 32;
+
+	BoardAnalytics();
+
+	void addBoard(PackedBoard board);
+	void addGame(GameTileType maxTile, int score);
+	void merge(const BoardAnalytics& other);
+
+	double getDistinctBoardCount() const { return distinctBoards.estimate(); }
+	std::uint64_t getBoardCount() const { return boardCounts.getTotalCount(); }
+	std::uint64_t getGameCount() const { return gameCount; }
+	// Sorted from the most frequent.
+	std::vector<BoardFrequency> getHeavyHitters() const;
+	const std::vector<std::uint64_t>& getMaxTileHistogram() const { return maxTileHistogram; }
+	const std::vector<std::uint64_t>& getScoreHistogram() const { return scoreHistogram; }
+
+	bool save(const std::string& path) const;
+	bool load(const std::string& path);
+};
+
+#endif // GAME_2048_ANALYTICS_H
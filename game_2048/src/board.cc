@@ -0,0 +1,211 @@
+#include "board.h"
+
+#include <array>
+
+#include "line_rules.h"
+#include "row_tables.h"
+
+namespace {
+
+// Row movement by the reference rules of GameField, with the score counted
+// the same way as in GameField::requestMovement.
+constexpr PackedRow moveRowByReference(PackedRow row, bool reversed, int& score, bool& isOverflow) {
+	FieldLine line{
+		.line = {
+			(GameTileType)(row & 0xF),
+			(GameTileType)((row >> 4) & 0xF),
+			(GameTileType)((row >> 8) & 0xF),
+			(GameTileType)((row >> 12) & 0xF),
+		},
+	};
+	LineMovements movements = moveFieldLine(line, reversed);
+	score = 0;
+	isOverflow = false;
+	for (int i = 0; i < movements.count; i++) {
+		const TileLineMovement& movement = movements.movements[i];
+		bool isUnique = true;
+		for (int j = 0; j < i; j++) {
+			if (movements.movements[j].to == movement.to) {
+				isUnique = false;
+			}
+		}
+		if ((int)movement.newTile > 15) {
+			isOverflow = true;
+		}
+		if (isUnique && movement.oldTile != GameTileType::NoTile && movement.oldTile != movement.newTile) {
+			score += 1 << (int)movement.newTile;
+		}
+	}
+	return (PackedRow)((int)line.line[0] | ((int)line.line[1] << 4) | 
+	                   ((int)line.line[2] << 8) | ((int)line.line[3] << 12));
+}
+
+// Every row except the ones that would merge two 32768 tiles, which do not fit in 4 bits.
+constexpr bool isMatchingReference(const RowTables& tables) {
+	for (int row = 0; row < kRowCount; row++) {
+		int leftScore = 0;
+		int rightScore = 0;
+		bool isLeftOverflow = false;
+		bool isRightOverflow = false;
+		PackedRow left = moveRowByReference((PackedRow)row, false, leftScore, isLeftOverflow);
+		PackedRow right = moveRowByReference((PackedRow)row, true, rightScore, isRightOverflow);
+		if (!isLeftOverflow && (tables.left[row] != left || tables.leftScore[row] != leftScore)) {
+			return false;
+		}
+		if (!isRightOverflow && (tables.right[row] != right || tables.rightScore[row] != rightScore)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+constexpr RowTables kRowTables = buildRowTables();
+static_assert(isMatchingReference(kRowTables), "Row tables do not match the GameField movement rules");
+
+const RowTables& getRowTables() {
+	return kRowTables;
+}
+
+// splitmix64 of the cell and tile index, NoTile keys are 0 so an empty board hashes to 0.
+constexpr std::array<std::uint64_t, 16 * 16> buildZobristKeys() {
+	std::array<std::uint64_t, 16 * 16> keys{};
+	for (int i = 0; i < 16 * 16; i++) {
+		if (i % 16 == 0) {
+			continue;
+		}
+		std::uint64_t key = 0x2048ULL + i * 0x9E3779B97F4A7C15ULL;
+		key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+		keys[i] = key ^ (key >> 31);
+	}
+	return keys;
+}
+
+constexpr std::array<std::uint64_t, 16 * 16> kZobristKeys = buildZobristKeys();
+
+PackedBoard moveRows(PackedBoard board, const PackedRow* rowTable, 
+                     const int* scoreTable, int* scoreGained) {
+	PackedBoard result = 0;
+	for (int y = 0; y < 4; y++) {
+		PackedRow row = getBoardRow(board, y);
+		result |= (PackedBoard)rowTable[row] << (16 * y);
+		if (scoreGained != nullptr) {
+			*scoreGained += scoreTable[row];
+		}
+	}
+	return result;
+}
+
+}
+
+GameTileType getBoardTile(PackedBoard board, int x, int y) {
+	return (GameTileType)((board >> (4 * (4 * y + x))) & 0xF);
+}
+
+PackedBoard setBoardTile(PackedBoard board, int x, int y, GameTileType tileType) {
+	int shift = 4 * (4 * y + x);
+	board &= ~((PackedBoard)0xF << shift);
+	return board | ((PackedBoard)tileType << shift);
+}
+
+PackedRow getBoardRow(PackedBoard board, int y) {
+	return (PackedRow)(board >> (16 * y));
+}
+
+PackedBoard transposeBoard(PackedBoard board) {
+	PackedBoard a1 = board & 0xF0F00F0FF0F00F0FULL;
+	PackedBoard a2 = board & 0x0000F0F00000F0F0ULL;
+	PackedBoard a3 = board & 0x0F0F00000F0F0000ULL;
+	PackedBoard a = a1 | (a2 << 12) | (a3 >> 12);
+	PackedBoard b1 = a & 0xFF00FF0000FF00FFULL;
+	PackedBoard b2 = a & 0x00FF00FF00000000ULL;
+	PackedBoard b3 = a & 0x00000000FF00FF00ULL;
+	return b1 | (b2 >> 24) | (b3 << 24);
+}
+
+PackedBoard flipBoardHorizontally(PackedBoard board) {
+	return ((board & 0x000F000F000F000FULL) << 12) | ((board & 0x00F000F000F000F0ULL) << 4) |
+	       ((board & 0x0F000F000F000F00ULL) >> 4) | ((board & 0xF000F000F000F000ULL) >> 12);
+}
+
+PackedBoard flipBoardVertically(PackedBoard board) {
+	return ((board & 0x000000000000FFFFULL) << 48) | ((board & 0x00000000FFFF0000ULL) << 16) |
+	       ((board & 0x0000FFFF00000000ULL) >> 16) | ((board & 0xFFFF000000000000ULL) >> 48);
+}
+
+std::uint64_t getZobristKey(int x, int y, GameTileType tileType) {
+	return kZobristKeys[16 * (4 * y + x) + ((int)tileType & 0xF)];
+}
+
+std::uint64_t getZobristHash(PackedBoard board) {
+	std::uint64_t hash = 0;
+	for (int i = 0; i < 16; i++) {
+		hash ^= kZobristKeys[16 * i + ((board >> (4 * i)) & 0xF)];
+	}
+	return hash;
+}
+
+int countEmptyTiles(PackedBoard board) {
+	int count = 0;
+	for (int i = 0; i < 16; i++) {
+		if (((board >> (4 * i)) & 0xF) == 0) {
+			count++;
+		}
+	}
+	return count;
+}
+
+GameTileType getMaxTile(PackedBoard board) {
+	int maxTile = 0;
+	for (int i = 0; i < 16; i++) {
+		int tile = (int)((board >> (4 * i)) & 0xF);
+		if (tile > maxTile) {
+			maxTile = tile;
+		}
+	}
+	return (GameTileType)maxTile;
+}
+
+PackedBoard moveBoard(PackedBoard board, UserMovement movement, int* scoreGained) {
+	const RowTables& tables = getRowTables();
+	switch (movement) {
+	case UserMovement::Left:
+		return moveRows(board, tables.left, tables.leftScore, scoreGained);
+	case UserMovement::Right:
+		return moveRows(board, tables.right, tables.rightScore, scoreGained);
+	case UserMovement::Up:
+		return transposeBoard(moveRows(transposeBoard(board), tables.left, 
+		                               tables.leftScore, scoreGained));
+	case UserMovement::Down:
+		return transposeBoard(moveRows(transposeBoard(board), tables.right, 
+		                               tables.rightScore, scoreGained));
+	case UserMovement::None:
+		break;
+	}
+	return board;
+}
+
+PackedBoard spawnRandomTile(PackedBoard board, std::uint64_t random) {
+	// one bit per empty tile, at the lowest bit of its nibble
+	PackedBoard emptyMask = board | (board >> 1);
+	emptyMask |= emptyMask >> 2;
+	emptyMask = ~emptyMask & 0x1111111111111111ULL;
+	int emptyCount = countEmptyTiles(board);
+	if (emptyCount == 0) {
+		return board;
+	}
+	int index = (int)((random >> 32) % emptyCount);
+	for (int i = 0; i < index; i++) {
+		emptyMask &= emptyMask - 1;
+	}
+	PackedBoard tileBit = emptyMask & (~emptyMask + 1);
+	bool is4Tile = (random & 0xFFFF) < (std::uint64_t)(kTile4SpawnProbability * 0x10000);
+	return board | (tileBit * (is4Tile ? 2 : 1));
+}
+
+bool isBoardFailed(PackedBoard board) {
+	return moveBoard(board, UserMovement::Left) == board &&
+	       moveBoard(board, UserMovement::Right) == board &&
+	       moveBoard(board, UserMovement::Up) == board &&
+	       moveBoard(board, UserMovement::Down) == board;
+}
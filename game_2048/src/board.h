@@ -0,0 +1,61 @@
+#ifndef GAME_2048_BOARD_H
+#define GAME_2048_BOARD_H
+
+#include <cstdint>
+
+#include "types.h"
+
+// Whole 4x4 field packed into 64 bits: every tile is a 4-bit exponent
+// (the GameTileType value), tile (x, y) is stored at bits [4 * (4 * y + x); +4).
+using PackedBoard = std::uint64_t;
+// One line of 4 tiles, tile 'i' is stored at bits [4 * i; +4).
+using PackedRow = std::uint16_t;
+
+const int kRowCount = 65536;
+
+// Probability that a spawned tile is Tile4 instead of Tile2 (see GameField::spawnNewTiles).
+const float kTile4SpawnProbability = 0.2f;
+
+GameTileType getBoardTile(PackedBoard board, int x, int y);
+PackedBoard setBoardTile(PackedBoard board, int x, int y, GameTileType tileType);
+
+PackedRow getBoardRow(PackedBoard board, int y);
+PackedBoard transposeBoard(PackedBoard board);
+// Mirror left to right.
+PackedBoard flipBoardHorizontally(PackedBoard board);
+// Mirror top to bottom.
+PackedBoard flipBoardVertically(PackedBoard board);
+
+// Zobrist hashing: the hash of a board is the XOR of the keys of its tiles, so a tile
+// change updates it with two XORs. Empty tiles have the key 0.
+std::uint64_t getZobristKey(int x, int y, GameTileType tileType);
+std::uint64_t getZobristHash(PackedBoard board);
+
+int countEmptyTiles(PackedBoard board);
+GameTileType getMaxTile(PackedBoard board);
+
+// Apply movement without spawning new tiles. Returns the same board if
+// movement is not available. Score of all merges is added to 'scoreGained'.
+PackedBoard moveBoard(PackedBoard board, UserMovement movement, int* scoreGained = nullptr);
+bool isBoardFailed(PackedBoard board);
+
+// Spawn Tile2 or Tile4 on a random empty tile, both picked from 'random' bits.
+PackedBoard spawnRandomTile(PackedBoard board, std::uint64_t random);
+
+// xorshift64*, for simulations that need a few bytes of state instead of the 5 KB of mt19937.
+class FastRandom {
+private:
+	std::uint64_t state;
+
+public:
+	explicit FastRandom(std::uint64_t seed) : state(seed | 1) {}
+
+	std::uint64_t next() {
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return state * 0x2545F4914F6CDD1DULL;
+	}
+};
+
+#endif // GAME_2048_BOARD_H
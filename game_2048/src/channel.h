@@ -0,0 +1,45 @@
+#ifndef GAME_2048_CHANNEL_H
+#define GAME_2048_CHANNEL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Lock-free bounded queue for exactly one producer thread and one consumer thread.
+template <typename T, std::size_t Capacity>
+class SpscChannel {
+private:
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	std::array<T, Capacity> items;
+	// head and tail are written by different threads, keep them on separate cache lines
+	alignas(64) std::atomic<std::size_t> head;
+	alignas(64) std::atomic<std::size_t> tail;
+
+public:
+	SpscChannel() : items{}, head(0), tail(0) {}
+
+	// Producer side. Returns false if the channel is full.
+	bool tryPush(const T& item) {
+		std::size_t currentTail = tail.load(std::memory_order_relaxed);
+		if (currentTail - head.load(std::memory_order_acquire) == Capacity) {
+			return false;
+		}
+		items[currentTail & (Capacity - 1)] = item;
+		tail.store(currentTail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer side. Returns false if the channel is empty.
+	bool tryPop(T& item) {
+		std::size_t currentHead = head.load(std::memory_order_relaxed);
+		if (currentHead == tail.load(std::memory_order_acquire)) {
+			return false;
+		}
+		item = items[currentHead & (Capacity - 1)];
+		head.store(currentHead + 1, std::memory_order_release);
+		return true;
+	}
+};
+
+#endif // GAME_2048_CHANNEL_H
@@ -0,0 +1,25 @@
+#include "config_file.h"
+
+#include <fstream>
+#include <sstream>
+
+bool readConfigFile(const std::string& path,
+                    const std::function<bool(const std::string& name, std::istream& value)>& readValue) {
+	std::ifstream file(path);
+	if (!file) {
+		return false;
+	}
+	std::string line;
+	while (std::getline(file, line)) {
+		line = line.substr(0, line.find('#'));
+		std::istringstream lineStream(line);
+		std::string name;
+		if (!(lineStream >> name)) {
+			continue;
+		}
+		if (!readValue(name, lineStream)) {
+			return false;
+		}
+	}
+	return true;
+}
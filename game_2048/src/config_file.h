@@ -0,0 +1,18 @@
+#ifndef GAME_2048_CONFIG_FILE_H
+#define GAME_2048_CONFIG_FILE_H
+
+#include <functional>
+#include <istream>
+#include <string>
+
+/*
+	Text files of "name value" lines, shared by the settings and the heuristic weights:
+	 - '#' starts a comment, empty lines are skipped;
+	 - 'readValue' gets every name with the rest of its line and returns false for an
+	   unknown name or a bad value, which fails the whole file.
+	Returns false if the file can't be opened.
+*/
+bool readConfigFile(const std::string& path,
+                    const std::function<bool(const std::string& name, std::istream& value)>& readValue);
+
+#endif // GAME_2048_CONFIG_FILE_H
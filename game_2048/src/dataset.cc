@@ -0,0 +1,203 @@
+#include "dataset.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "symmetry.h"
+
+/*
+	Dataset file layout (little-endian):
+	 - "2048DATA", u32 version, u32 samples per chunk, u64 sample count, u32 chunk count, u32 flags,
+	   padded to 64 bytes; the counts are 0 until the writer is closed, then the chunks
+	   run to the end of the file;
+	 - chunks, every one: DatasetChunkHeader ("CHNK"), then the columns
+	   u64 boards[n], f32 rewards[n], i32 outcomes[n], u8 movements[n],
+	   padded to a multiple of 64 bytes, so the boards of every chunk stay aligned.
+*/
+const char kDatasetMagic[8] = { '2', '0', '4', '8', 'D', 'A', 'T', 'A' };
+const std::uint32_t kDatasetVersion = 2;
+const char kDatasetChunkMagic[4] = { 'C', 'H', 'N', 'K' };
+const std::uint32_t kDatasetFlagDeduplicated = 1;
+
+namespace {
+
+struct DatasetHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t chunkCapacity;
+	std::uint64_t sampleCount;
+	std::uint32_t chunkCount;
+	std::uint32_t flags;
+	std::uint8_t reserved[32];
+};
+
+static_assert(sizeof(DatasetHeader) == 64, "Dataset header must be 64 bytes");
+
+std::uint64_t getChunkSize(std::uint64_t sampleCount) {
+	std::uint64_t size = sizeof(DatasetChunkHeader) + sampleCount * (sizeof(PackedBoard) + sizeof(float) +
+	                                                                 sizeof(std::int32_t) + sizeof(std::uint8_t));
+	return (size + 63) / 64 * 64;
+}
+
+template <typename T>
+void writeColumn(std::ofstream& file, const std::vector<T>& column) {
+	file.write((const char*)column.data(), column.size() * sizeof(T));
+}
+
+}
+
+DatasetWriter::DatasetWriter() : chunkCapacity(kDatasetChunkSize), isDeduplicated(false),
+	sampleCount(0), duplicateCount(0), chunkCount(0) {}
+
+DatasetWriter::~DatasetWriter() {
+	if (file.is_open()) {
+		close();
+	}
+}
+
+bool DatasetWriter::open(const std::string& path, bool deduplicate, std::uint32_t samplesPerChunk) {
+	file.open(path, std::ios::binary | std::ios::trunc);
+	if (!file) {
+		return false;
+	}
+	chunkCapacity = std::max(1u, samplesPerChunk);
+	isDeduplicated = deduplicate;
+	sampleCount = 0;
+	duplicateCount = 0;
+	chunkCount = 0;
+	seenBoards.clear();
+	// rewritten with the totals by close()
+	return writeHeader();
+}
+
+bool DatasetWriter::writeHeader() {
+	DatasetHeader header{
+		.magic = {},
+		.version = kDatasetVersion,
+		.chunkCapacity = chunkCapacity,
+		.sampleCount = sampleCount,
+		.chunkCount = chunkCount,
+		.flags = isDeduplicated ? kDatasetFlagDeduplicated : 0,
+		.reserved = {},
+	};
+	std::memcpy(header.magic, kDatasetMagic, sizeof(header.magic));
+	file.seekp(0);
+	file.write((const char*)&header, sizeof(header));
+	file.flush();
+	return (bool)file;
+}
+
+bool DatasetWriter::add(const DatasetSample& sample) {
+	PackedBoard board = sample.board;
+	UserMovement movement = sample.movement;
+	if (isDeduplicated) {
+		CanonicalBoard canonical = canonicalizeBoard(board);
+		if (!seenBoards.insert(canonical.board).second) {
+			duplicateCount++;
+			return true;
+		}
+		board = canonical.board;
+		movement = transformMovement(movement, canonical.transform);
+	}
+	boards.push_back(board);
+	rewards.push_back(sample.reward);
+	outcomes.push_back(sample.outcome);
+	movements.push_back((std::uint8_t)movement);
+	sampleCount++;
+	return boards.size() < chunkCapacity || writeChunk();
+}
+
+bool DatasetWriter::writeChunk() {
+	if (boards.empty()) {
+		return true;
+	}
+	std::uint32_t count = (std::uint32_t)boards.size();
+	DatasetChunkHeader header{};
+	std::memcpy(header.magic, kDatasetChunkMagic, sizeof(header.magic));
+	header.sampleCount = count;
+	header.size = getChunkSize(count);
+	header.rewardMax = rewards[0];
+	header.outcomeMin = outcomes[0];
+	header.outcomeMax = outcomes[0];
+	for (std::uint32_t i = 0; i < count; i++) {
+		if (movements[i] >= (std::uint8_t)UserMovement::Left && movements[i] <= (std::uint8_t)UserMovement::Down) {
+			header.movementCounts[movements[i] - 1]++;
+		}
+		header.rewardSum += rewards[i];
+		header.rewardMax = std::max(header.rewardMax, rewards[i]);
+		header.outcomeMin = std::min(header.outcomeMin, outcomes[i]);
+		header.outcomeMax = std::max(header.outcomeMax, outcomes[i]);
+		header.maxTile = std::max(header.maxTile, (std::uint8_t)getMaxTile(boards[i]));
+	}
+	file.write((const char*)&header, sizeof(header));
+	writeColumn(file, boards);
+	writeColumn(file, rewards);
+	writeColumn(file, outcomes);
+	writeColumn(file, movements);
+	std::uint64_t writtenSize = sizeof(header) + count * (sizeof(PackedBoard) + sizeof(float) +
+	                                                      sizeof(std::int32_t) + sizeof(std::uint8_t));
+	const char padding[64] = {};
+	file.write(padding, header.size - writtenSize);
+
+	boards.clear();
+	rewards.clear();
+	outcomes.clear();
+	movements.clear();
+	chunkCount++;
+	// a reader of the unfinished file sees whole chunks
+	file.flush();
+	return (bool)file;
+}
+
+bool DatasetWriter::close() {
+	bool isWritten = writeChunk();
+	isWritten = writeHeader() && isWritten;
+	file.close();
+	return isWritten;
+}
+
+DatasetReader::DatasetReader() : sampleCount(0), isDeduplicated(false) {}
+
+bool DatasetReader::open(const std::string& path) {
+	chunks.clear();
+	if (!file.openForReading(path) || file.getSize() < sizeof(DatasetHeader)) {
+		return false;
+	}
+	const std::uint8_t* data = (const std::uint8_t*)file.getData();
+	DatasetHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	if (std::memcmp(header.magic, kDatasetMagic, sizeof(header.magic)) != 0 || header.version != kDatasetVersion) {
+		return false;
+	}
+	sampleCount = 0;
+	isDeduplicated = (header.flags & kDatasetFlagDeduplicated) != 0;
+	// a file that is still being written has no chunk count, its chunks are read up to
+	// the last complete one
+	bool isClosed = header.chunkCount != 0;
+	std::size_t offset = sizeof(header);
+	for (std::uint32_t i = 0; isClosed ? i < header.chunkCount : file.getSize() > offset; i++) {
+		if (file.getSize() - offset < sizeof(DatasetChunkHeader)) {
+			return !isClosed;
+		}
+		const DatasetChunkHeader* chunkHeader = (const DatasetChunkHeader*)(data + offset);
+		std::uint64_t count = chunkHeader->sampleCount;
+		if (std::memcmp(chunkHeader->magic, kDatasetChunkMagic, sizeof(chunkHeader->magic)) != 0 ||
+		    chunkHeader->size != getChunkSize(count)) {
+			return false;
+		}
+		if (file.getSize() - offset < chunkHeader->size) {
+			return !isClosed;
+		}
+		const std::uint8_t* columns = data + offset + sizeof(DatasetChunkHeader);
+		chunks.push_back(DatasetChunk{
+			.header = chunkHeader,
+			.boards = (const PackedBoard*)columns,
+			.rewards = (const float*)(columns + count * sizeof(PackedBoard)),
+			.outcomes = (const std::int32_t*)(columns + count * (sizeof(PackedBoard) + sizeof(float))),
+			.movements = columns + count * (sizeof(PackedBoard) + sizeof(float) + sizeof(std::int32_t)),
+		});
+		sampleCount += count;
+		offset += chunkHeader->size;
+	}
+	return !isClosed || sampleCount == header.sampleCount;
+}
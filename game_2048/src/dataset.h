@@ -0,0 +1,114 @@
+#ifndef GAME_2048_DATASET_H
+#define GAME_2048_DATASET_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "board.h"
+#include "mapped_file.h"
+
+// Samples per chunk unless the writer is told otherwise.
+const std::uint32_t kDatasetChunkSize = 65536;
+
+struct DatasetSample {
+	PackedBoard board; // before the movement
+	UserMovement movement;
+	float reward; // score gained by the movement
+	std::int32_t outcome; // final score of the game
+};
+
+/*
+	Statistics of the samples of one chunk, so a reader can skip or weight whole chunks
+	without touching their columns.
+*/
+struct DatasetChunkHeader {
+	char magic[4];
+	std::uint32_t sampleCount;
+	std::uint64_t size; // of the whole chunk with this header, the next chunk starts right after it
+	std::uint32_t movementCounts[4]; // by UserMovement - 1
+	double rewardSum;
+	float rewardMax;
+	std::int32_t outcomeMin;
+	std::int32_t outcomeMax;
+	std::uint8_t maxTile; // exponent
+	std::uint8_t reserved[11];
+};
+
+static_assert(sizeof(DatasetChunkHeader) == 64, "Dataset chunk header must be 64 bytes");
+
+// Columns of one chunk, pointing into the mapped file.
+struct DatasetChunk {
+	const DatasetChunkHeader* header;
+	const PackedBoard* boards;
+	const float* rewards;
+	const std::int32_t* outcomes;
+	const std::uint8_t* movements; // UserMovement values
+};
+
+/*
+	Writes samples in chunks of columns, for training code that maps the file or streams
+	it chunk by chunk:
+	 - every chunk is a DatasetChunkHeader followed by one contiguous array per field;
+	 - every chunk is flushed when it is full, and the totals in the file header are written
+	   by close(), so a reader of an unfinished file gets the chunks written so far;
+	 - with deduplication every canonical board is kept once, and samples are stored
+	   in the canonical orientation (board and movement transformed together).
+*/
+class DatasetWriter {
+private:
+	std::ofstream file;
+	std::uint32_t chunkCapacity;
+	bool isDeduplicated;
+
+	std::vector<PackedBoard> boards;
+	std::vector<float> rewards;
+	std::vector<std::int32_t> outcomes;
+	std::vector<std::uint8_t> movements;
+
+	std::unordered_set<PackedBoard> seenBoards;
+	std::uint64_t sampleCount;
+	std::uint64_t duplicateCount;
+	std::uint32_t chunkCount;
+
+	bool writeHeader();
+	bool writeChunk();
+
+public:
+	DatasetWriter();
+	~DatasetWriter();
+
+	DatasetWriter(const DatasetWriter&) = delete;
+	DatasetWriter& operator=(const DatasetWriter&) = delete;
+
+	bool open(const std::string& path, bool deduplicate, std::uint32_t samplesPerChunk = kDatasetChunkSize);
+	bool add(const DatasetSample& sample);
+	// Writes the last chunk and the totals.
+	bool close();
+
+	std::uint64_t getSampleCount() const { return sampleCount; }
+	std::uint64_t getDuplicateCount() const { return duplicateCount; }
+};
+
+// Maps a file written by DatasetWriter, the chunks are found once on open(), so reopen
+// a file that is still being written to see its newer chunks.
+class DatasetReader {
+private:
+	MappedFile file;
+	std::vector<DatasetChunk> chunks;
+	std::uint64_t sampleCount;
+	bool isDeduplicated;
+
+public:
+	DatasetReader();
+
+	bool open(const std::string& path);
+
+	std::uint64_t getSampleCount() const { return sampleCount; }
+	bool getIsDeduplicated() const { return isDeduplicated; }
+	const std::vector<DatasetChunk>& getChunks() const { return chunks; }
+};
+
+#endif // GAME_2048_DATASET_H
@@ -0,0 +1,91 @@
+#include "environment.h"
+
+#include "montecarlo.h"
+
+namespace {
+
+const int kMovementCount = 4;
+
+}
+
+BatchedEnvironment::BatchedEnvironment(int gameCount, std::uint64_t seed) : gameCount(gameCount),
+	boards(gameCount, 0), scores(gameCount, 0), movedBoards(gameCount * kMovementCount, 0),
+	movementScores(gameCount * kMovementCount, 0), batchBoards(gameCount * kMovementCount, 0),
+	batchMovements(gameCount * kMovementCount, UserMovement::None) {
+	randomGenerators.reserve(gameCount);
+	for (int k = 0; k < gameCount; k++) {
+		randomGenerators.emplace_back(seed + (std::uint64_t)(k + 1) * 0x9E3779B97F4A7C15ULL);
+		for (int m = 0; m < kMovementCount; m++) {
+			batchMovements[k * kMovementCount + m] = (UserMovement)(m + 1);
+		}
+	}
+}
+
+void BatchedEnvironment::updateMovedBoards() {
+	for (int k = 0; k < gameCount; k++) {
+		for (int m = 0; m < kMovementCount; m++) {
+			batchBoards[k * kMovementCount + m] = boards[k];
+			// moveBoards() adds to the scores
+			movementScores[k * kMovementCount + m] = 0;
+		}
+	}
+	moveBoards(batchBoards.data(), batchMovements.data(), movedBoards.data(), movementScores.data(),
+	           gameCount * kMovementCount);
+}
+
+void BatchedEnvironment::writeResults(std::uint8_t* observations, std::uint8_t* done, std::uint8_t* legalMoves) const {
+	for (int k = 0; k < gameCount; k++) {
+		if (observations != nullptr) {
+			for (int i = 0; i < 16; i++) {
+				observations[16 * k + i] = (std::uint8_t)((boards[k] >> (4 * i)) & 0xF);
+			}
+		}
+		std::uint8_t legalMask = 0;
+		for (int m = 0; m < kMovementCount; m++) {
+			if (movedBoards[k * kMovementCount + m] != boards[k]) {
+				legalMask |= (std::uint8_t)(1 << m);
+			}
+		}
+		if (legalMoves != nullptr) {
+			legalMoves[k] = legalMask;
+		}
+		if (done != nullptr) {
+			done[k] = legalMask == 0 ? 1 : 0;
+		}
+	}
+}
+
+void BatchedEnvironment::reset(const std::uint8_t* mask, std::uint8_t* observations,
+                               std::uint8_t* done, std::uint8_t* legalMoves) {
+	for (int k = 0; k < gameCount; k++) {
+		if (mask != nullptr && mask[k] == 0) {
+			continue;
+		}
+		// two tiles at the start, like GameField::spawnNewTiles()
+		boards[k] = spawnRandomTile(spawnRandomTile(0, randomGenerators[k].next()), randomGenerators[k].next());
+		scores[k] = 0;
+	}
+	updateMovedBoards();
+	writeResults(observations, done, legalMoves);
+}
+
+void BatchedEnvironment::step(const UserMovement* actions, std::uint8_t* observations, float* rewards,
+                              std::uint8_t* done, std::uint8_t* legalMoves) {
+	for (int k = 0; k < gameCount; k++) {
+		int reward = 0;
+		int movement = (int)actions[k] - 1;
+		if (movement >= 0 && movement < kMovementCount) {
+			PackedBoard movedBoard = movedBoards[k * kMovementCount + movement];
+			if (movedBoard != boards[k]) {
+				reward = movementScores[k * kMovementCount + movement];
+				boards[k] = spawnRandomTile(movedBoard, randomGenerators[k].next());
+				scores[k] += reward;
+			}
+		}
+		if (rewards != nullptr) {
+			rewards[k] = (float)reward;
+		}
+	}
+	updateMovedBoards();
+	writeResults(observations, done, legalMoves);
+}
@@ -0,0 +1,52 @@
+#ifndef GAME_2048_ENVIRONMENT_H
+#define GAME_2048_ENVIRONMENT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+
+/*
+	K games stepped together for reinforcement learning, same rules as GameField.
+	State is kept as separate arrays (boards, scores, random generators) and all
+	results are written into caller buffers, nothing is allocated after construction:
+	 - observations: K * 16 tile exponents, tile (x, y) at [16 * k + 4 * y + x], 0 - empty;
+	 - rewards: score gained by the movement, as GameField::requestMovement() counts it;
+	 - done: 1 if no movement is possible anymore, as GameField::isGameFailed();
+	 - legal moves: bit (movement - 1) is set for every UserMovement that changes the board.
+	A movement that does not change the board is a no-op with zero reward and no spawn.
+	Any output pointer may be nullptr to skip it.
+*/
+class BatchedEnvironment {
+private:
+	int gameCount;
+
+	std::vector<PackedBoard> boards;
+	std::vector<int> scores;
+	std::vector<FastRandom> randomGenerators;
+
+	// All four movements of every board, computed in one batch after each step,
+	// so the next step and the legal move masks only look them up.
+	std::vector<PackedBoard> movedBoards;
+	std::vector<int> movementScores;
+	std::vector<PackedBoard> batchBoards;
+	std::vector<UserMovement> batchMovements;
+
+	void updateMovedBoards();
+	void writeResults(std::uint8_t* observations, std::uint8_t* done, std::uint8_t* legalMoves) const;
+
+public:
+	BatchedEnvironment(int gameCount, std::uint64_t seed);
+
+	// Starts a new game where mask[k] != 0, every game if mask is nullptr.
+	void reset(const std::uint8_t* mask, std::uint8_t* observations, std::uint8_t* done, std::uint8_t* legalMoves);
+	// Applies actions[k] to game k, finished games are left as they are until reset.
+	void step(const UserMovement* actions, std::uint8_t* observations, float* rewards,
+	          std::uint8_t* done, std::uint8_t* legalMoves);
+
+	int getGameCount() const { return gameCount; }
+	const PackedBoard* getBoards() const { return boards.data(); }
+	const int* getScores() const { return scores.data(); }
+};
+
+#endif // GAME_2048_ENVIRONMENT_H
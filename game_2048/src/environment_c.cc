@@ -0,0 +1,55 @@
+#include "environment_c.h"
+
+#include <vector>
+
+#include "environment.h"
+
+struct Game2048Environment {
+	BatchedEnvironment environment;
+	// converted actions, kept to avoid allocating on every step
+	std::vector<UserMovement> actions;
+};
+
+Game2048Environment* game2048_env_create(int32_t game_count, uint64_t seed) {
+	if (game_count <= 0) {
+		return nullptr;
+	}
+	return new Game2048Environment{
+		.environment = BatchedEnvironment(game_count, seed),
+		.actions = std::vector<UserMovement>(game_count, UserMovement::None),
+	};
+}
+
+void game2048_env_destroy(Game2048Environment* environment) {
+	delete environment;
+}
+
+int32_t game2048_env_game_count(const Game2048Environment* environment) {
+	return environment->environment.getGameCount();
+}
+
+void game2048_env_reset(Game2048Environment* environment, const uint8_t* mask,
+                        uint8_t* observations, uint8_t* done, uint8_t* legal_moves) {
+	environment->environment.reset(mask, observations, done, legal_moves);
+}
+
+void game2048_env_step(Game2048Environment* environment, const int32_t* actions,
+                       uint8_t* observations, float* rewards, uint8_t* done, uint8_t* legal_moves) {
+	for (std::size_t k = 0; k < environment->actions.size(); k++) {
+		bool isValid = actions[k] >= 0 && actions[k] < 4;
+		environment->actions[k] = isValid ? (UserMovement)(actions[k] + 1) : UserMovement::None;
+	}
+	environment->environment.step(environment->actions.data(), observations, rewards, done, legal_moves);
+}
+
+void game2048_env_get_boards(const Game2048Environment* environment, uint64_t* boards, int32_t* scores) {
+	const BatchedEnvironment& batched = environment->environment;
+	for (int k = 0; k < batched.getGameCount(); k++) {
+		if (boards != nullptr) {
+			boards[k] = batched.getBoards()[k];
+		}
+		if (scores != nullptr) {
+			scores[k] = batched.getScores()[k];
+		}
+	}
+}
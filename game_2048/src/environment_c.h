@@ -0,0 +1,42 @@
+#ifndef GAME_2048_ENVIRONMENT_C_H
+#define GAME_2048_ENVIRONMENT_C_H
+
+/*
+	C interface of BatchedEnvironment for training scripts (e.g. Python ctypes or cffi).
+	Actions are 0 - left, 1 - right, 2 - up, 3 - down, bit 'action' of a legal move mask
+	is set if the action changes the board. Buffer layouts are described in environment.h,
+	all buffers are owned by the caller and any output may be NULL.
+*/
+
+#include <stdint.h>
+
+#ifdef _WIN32
+#define GAME_2048_ENV_API __declspec(dllexport)
+#else
+#define GAME_2048_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Game2048Environment Game2048Environment;
+
+GAME_2048_ENV_API Game2048Environment* game2048_env_create(int32_t game_count, uint64_t seed);
+GAME_2048_ENV_API void game2048_env_destroy(Game2048Environment* environment);
+GAME_2048_ENV_API int32_t game2048_env_game_count(const Game2048Environment* environment);
+
+// observations: game_count * 16 bytes, done and legal_moves: game_count bytes.
+GAME_2048_ENV_API void game2048_env_reset(Game2048Environment* environment, const uint8_t* mask,
+                                          uint8_t* observations, uint8_t* done, uint8_t* legal_moves);
+// rewards: game_count floats.
+GAME_2048_ENV_API void game2048_env_step(Game2048Environment* environment, const int32_t* actions,
+                                         uint8_t* observations, float* rewards, uint8_t* done, uint8_t* legal_moves);
+// Packed boards (see board.h) and total scores of all games, game_count entries each.
+GAME_2048_ENV_API void game2048_env_get_boards(const Game2048Environment* environment, uint64_t* boards, int32_t* scores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GAME_2048_ENVIRONMENT_C_H
@@ -2,40 +2,215 @@
 
 #include <iostream>
 
-Game2048::Game2048() : currentScreenType(GameScreenType::MainMenu) {
+Game2048::Game2048() : startTime(std::chrono::steady_clock::now()), isFirstFrameReported(false),
+	settings(loadStartupSettings()), window(settings), currentScreenType(GameScreenType::MainMenu),
+	isAdviceRequested(false), advisedBoard(0), heuristicWeightsTime{}, heuristicCheckTime(0.0),
+	isSimulationOnly(false), tickAccumulator(0.0), previousTickTime(0.0) {
+	reportStartup("window and main menu created");
 	window.setCurrentScreen(&mainMenuScreen);
-    initializeField();
+	moveAdvisor.setThinkTime(settings.aiThinkTime);
+	// only mapped, pages are read on the first lookups
+	if (openingBook.open(kOpeningBookFile)) {
+		moveAdvisor.setOpeningBook(&openingBook);
+		std::cout << "Loaded opening book with " << openingBook.getEntryCount() << " positions" << std::endl;
+	}
+	tileAssets = std::async(std::launch::async, prepareTileAssets).share();
+	valueNetworkLoading = std::async(std::launch::async, [this] {
+		if (!valueNetwork.load(kNTupleWeightsFile)) {
+			return false;
+		}
+		valueNetwork.quantize();
+		return true;
+	});
+}
+
+void Game2048::reportStartup(const char* stage) {
+	double milliseconds = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - startTime).count();
+	std::cout << "Startup: " << stage << " in " << milliseconds << " ms" << std::endl;
+}
+
+// Takes the results of the background tasks as soon as they are ready, never waits for them.
+void Game2048::processBackgroundLoading() {
+	if (valueNetworkLoading.valid() && 
+	    valueNetworkLoading.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		if (valueNetworkLoading.get()) {
+			moveAdvisor.setEvaluator(&valueNetwork);
+			std::cout << "Loaded n-tuple weights from " << kNTupleWeightsFile << std::endl;
+		}
+		reportStartup("n-tuple weights checked");
+	}
+}
+
+// Reloads the heuristic weights whenever their file changes, so they can be tuned
+// while the AI plays. Checked once per second, the new weights apply from the next search.
+void Game2048::processHeuristicWeights() {
+	if (GetTime() - heuristicCheckTime < 1.0) {
+		return;
+	}
+	heuristicCheckTime = GetTime();
+	std::error_code error;
+	auto modificationTime = std::filesystem::last_write_time(kHeuristicWeightsFile, error);
+	if (error || modificationTime == heuristicWeightsTime) {
+		return;
+	}
+	heuristicWeightsTime = modificationTime;
+	if (getDefaultHeuristic().loadWeights(kHeuristicWeightsFile)) {
+		std::cout << "Loaded heuristic weights from " << kHeuristicWeightsFile << std::endl;
+	}
+	else {
+		std::cout << "Failed to load heuristic weights from " << kHeuristicWeightsFile << std::endl;
+	}
 }
 
+/*
+	Main loop layout:
+	 - Input is handled once per rendered frame (screen process + navigation);
+	 - Logic (animations, automatic moves) advances in fixed ticks of
+	   kLogicTickDuration, so it runs at the same speed for any render rate;
+	 - In "simulation only" mode ticks are not paced at all: they run back
+	   to back and a frame is rendered only kSimulationRenderRate times per second.
+	   A tick with nothing to do waits for the advisor instead of spinning.
+*/
 void Game2048::run() {
+	previousTickTime = GetTime();
 	while (!window.shouldBeClosed()) {
 		window.updateLogic();
-		switch (currentScreenType) {
-		case GameScreenType::MainMenu: {
-			processMainMenu();
-			break;
+		processCurrentScreen();
+		if (isSimulationOnly) {
+			runSimulationTicks();
 		}
-		case GameScreenType::Settings: {
-			processSettings();
-			break;
+		else {
+			runTicks();
+		}
+		window.drawFrame();
+		if (!isFirstFrameReported) {
+			isFirstFrameReported = true;
+			reportStartup("first frame presented");
 		}
-		case GameScreenType::Game: {
-			processGame();
+		processBackgroundLoading();
+		processHeuristicWeights();
+	}
+}
+
+void Game2048::setSimulationOnly(bool simulationOnly) {
+	if (isSimulationOnly == simulationOnly) {
+		return;
+	}
+	isSimulationOnly = simulationOnly;
+	window.setSimulationOnly(simulationOnly);
+	gameScreen->setAnimationsEnabled(!simulationOnly);
+	tickAccumulator = 0.0;
+	previousTickTime = GetTime();
+}
+
+void Game2048::runTicks() {
+	double currentTime = GetTime();
+	tickAccumulator += currentTime - previousTickTime;
+	previousTickTime = currentTime;
+	int ticksDone = 0;
+	while (tickAccumulator >= kLogicTickDuration) {
+		if (ticksDone == kMaxTicksPerFrame) {
+			// too far behind (window dragged, debugger break) - drop the backlog
+			tickAccumulator = 0.0;
 			break;
 		}
+		tick();
+		tickAccumulator -= kLogicTickDuration;
+		ticksDone++;
+	}
+}
+
+void Game2048::runSimulationTicks() {
+	double renderTime = GetTime() + (1.0 / kSimulationRenderRate);
+	do {
+		// idle ticks only poll an empty channel, sleep until there is advice or a frame is due
+		if (!tick()) {
+			double remainingTime = renderTime - GetTime();
+			if (remainingTime > 0) {
+				moveAdvisor.waitForMove(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+					std::chrono::duration<double>(remainingTime)));
+			}
 		}
-		window.drawFrame();
+	} while (GetTime() < renderTime);
+	previousTickTime = GetTime();
+}
+
+bool Game2048::tick() {
+	window.updateTick();
+	if (currentScreenType != GameScreenType::Game) {
+		return false;
+	}
+	bool isMoved = processAutoplay();
+	return isMoved || gameScreen->isAnimating();
+}
+
+void Game2048::processCurrentScreen() {
+	switch (currentScreenType) {
+	case GameScreenType::MainMenu: {
+		processMainMenu();
+		break;
+	}
+	case GameScreenType::Settings: {
+		processSettings();
+		break;
+	}
+	case GameScreenType::Game: {
+		processGame();
+		break;
 	}
+	case GameScreenType::Tournament: {
+		processTournament();
+		break;
+	}
+	}
+}
+
+void Game2048::showMainMenu() {
+	currentScreenType = GameScreenType::MainMenu;
+	window.setCurrentScreen(&mainMenuScreen);
+}
+
+void Game2048::showSettings() {
+	if (!settingsScreen) {
+		settingsScreen = std::make_unique<SettingsGUI>(settings);
+		reportStartup("settings screen created");
+	}
+	currentScreenType = GameScreenType::Settings;
+	window.setCurrentScreen(settingsScreen.get());
+}
+
+void Game2048::showGame() {
+	if (!gameScreen) {
+		// the assets are usually ready long before the first click on "PLAY"
+		gameScreen = std::make_unique<GameGUI>(tileAssets.get());
+		gameScreen->setAnimationDuration(settings.animationDuration);
+		initializeField();
+		reportStartup("game screen created");
+	}
+	currentScreenType = GameScreenType::Game;
+	window.setCurrentScreen(gameScreen.get());
+}
+
+void Game2048::showTournament() {
+	if (!tournamentScreen) {
+		tournamentScreen = std::make_unique<TournamentGUI>(tileAssets.get());
+		reportStartup("tournament screen created");
+	}
+	tournamentScreen->setPaused(false);
+	currentScreenType = GameScreenType::Tournament;
+	window.setCurrentScreen(tournamentScreen.get());
 }
 
 void Game2048::processMainMenu() {
 	if (mainMenuScreen.isPlayButtonClicked()) {
-		currentScreenType = GameScreenType::Game;
-		window.setCurrentScreen(&gameScreen);
+		showGame();
+	}
+	if (mainMenuScreen.isTournamentButtonClicked()) {
+		showTournament();
 	}
 	if (mainMenuScreen.isSettingsButtonClicked()) {
-		currentScreenType = GameScreenType::Settings;
-		window.setCurrentScreen(&settingsScreen);
+		showSettings();
 	}
 	if (mainMenuScreen.isExitButtonClicked()) {
 		window.askToClose();
@@ -43,42 +218,109 @@ void Game2048::processMainMenu() {
 }
 
 void Game2048::processSettings() {
-	if (settingsScreen.isBackButtonClicked()) {
-		currentScreenType = GameScreenType::MainMenu;
-		window.setCurrentScreen(&mainMenuScreen);
+	if (settingsScreen->getIsChangeAsked()) {
+		settings = settingsScreen->getSettings();
+		applySettings();
+		if (!saveSettings(kSettingsFile, settings)) {
+			std::cout << "Failed to save " << kSettingsFile << std::endl;
+		}
+	}
+	if (settingsScreen->isBackButtonClicked()) {
+		showMainMenu();
+	}
+}
+
+// Everything that can change without a restart, MSAA waits for the next start.
+void Game2048::applySettings() {
+	window.applySettings(settings);
+	if (gameScreen) {
+		gameScreen->setAnimationDuration(settings.animationDuration);
+	}
+	moveAdvisor.setThinkTime(settings.aiThinkTime);
+}
+
+void Game2048::processTournament() {
+	if (tournamentScreen->isBackButtonClicked()) {
+		tournamentScreen->setPaused(true);
+		showMainMenu();
 	}
 }
 
 void Game2048::processGame() {
-	if (gameScreen.isBackButtonClicked()) {
-		currentScreenType = GameScreenType::MainMenu;
-		window.setCurrentScreen(&mainMenuScreen);
+	if (gameScreen->isBackButtonClicked()) {
+		setSimulationOnly(false);
+		showMainMenu();
 	    return;
     }
-    if (gameScreen.getIsResetAsked()) {
+	if (gameScreen->getIsSimulationToggleAsked()) {
+		setSimulationOnly(!isSimulationOnly);
+	}
+    if (gameScreen->getIsResetAsked()) {
         gameField.reset();
-        gameScreen.reset();
+        gameScreen->reset();
         initializeField();
         return;
     }
-	UserMovement userMove = gameScreen.getUserMovement();
-	if (userMove != UserMovement::None && !gameField.isGameFailed()) {
-		auto fieldChanges = gameField.requestMovement(userMove);
+	applyMovement(gameScreen->getUserMovement());
+	processHints();
+}
+
+// Hints are computed on this thread, but only for a small part of every frame.
+void Game2048::processHints() {
+	if (!gameScreen->getIsHintEnabled() || gameField.isGameFailed()) {
+		return;
+	}
+	PackedBoard board = gameField.getBoard();
+	hintAnalyzer.setBoard(board);
+	hintAnalyzer.advance(getHintFrameBudget(settings.framerate));
+	gameScreen->setHints(hintAnalyzer.getHints(), hintAnalyzer.getCompletedDepth());
+}
+
+// Moves suggested by the background MoveAdvisor. The search never runs on
+// this thread: a snapshot is posted once per board and the answer is polled.
+bool Game2048::processAutoplay() {
+	if (!gameScreen->getIsAutoplayEnabled() || gameScreen->isAnimating()) {
+		return false;
+	}
+	moveAdvisor.setPolicy(gameScreen->getAutoplayPolicy());
+	PackedBoard board = gameField.getBoard();
+	if (!isAdviceRequested || advisedBoard != board) {
+		if (isBoardFailed(board)) {
+			return false;
+		}
+		isAdviceRequested = moveAdvisor.requestMove(board);
+		advisedBoard = board;
+		return false;
+	}
+	MoveAdvice advice;
+	while (moveAdvisor.pollMove(advice)) {
+		if (advice.board == board) {
+			isAdviceRequested = false;
+			applyMovement(advice.movement);
+			return true;
+		}
+	}
+	return false;
+}
+
+void Game2048::applyMovement(UserMovement movement) {
+	if (movement != UserMovement::None && !gameField.isGameFailed()) {
+		auto fieldChanges = gameField.requestMovement(movement);
 		if (fieldChanges.size() > 0) {
 			for (auto& tileMove : fieldChanges) {
-				gameScreen.moveTile(tileMove.fromX, tileMove.fromY, 
+				gameScreen->moveTile(tileMove.fromX, tileMove.fromY, 
                                     tileMove.toX, tileMove.toY, 
                                     tileMove.oldTile, tileMove.newTile);
 			}
 			auto spawnedTiles = gameField.spawnNewTiles();
 			for (auto& spawnedTile : spawnedTiles) {
-				gameScreen.setTile(spawnedTile.x, spawnedTile.y, 
+				gameScreen->setTile(spawnedTile.x, spawnedTile.y, 
                                    spawnedTile.tileType);
 			}
-			gameScreen.updateScore(gameField.getScore());
+			gameScreen->updateScore(gameField.getScore());
 		}
         if (gameField.isGameFailed()) {
-            gameScreen.setGameFailed();
+            gameScreen->setGameFailed();
         }
 	}
 }
@@ -87,7 +329,7 @@ void Game2048::initializeField() {
 	if (!gameField.isGameInitialized()) {
 		auto spawnedTiles = gameField.spawnNewTiles();
 		for (auto& spawnedTile : spawnedTiles) {
-			gameScreen.setTile(spawnedTile.x, spawnedTile.y, 
+			gameScreen->setTile(spawnedTile.x, spawnedTile.y, 
                                spawnedTile.tileType);
 		}
 	}
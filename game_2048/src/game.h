@@ -1,30 +1,91 @@
 #ifndef GAME_2048_GAME_H
 #define GAME_2048_GAME_H
 
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <memory>
+
 #include "window.h"
 #include "logic.h"
+#include "ai.h"
+#include "hint.h"
+#include "ntuple.h"
+#include "heuristic.h"
+#include "tournament.h"
 
 enum class GameScreenType {
 	MainMenu = 0,
 	Settings,
-	Game
+	Game,
+	Tournament
 };
 
 class Game2048 {
 private:
+	// first, so the startup report also covers the window creation
+	std::chrono::steady_clock::time_point startTime;
+	bool isFirstFrameReported;
+
+	// read before the window is created, MSAA can only be set then
+	GameSettings settings;
 	GameWindow window;
 
 	GameScreenType currentScreenType;
 
 	MainMenuGUI mainMenuScreen;
-	SettingsGUI settingsScreen;
-	GameGUI gameScreen;
+	// created on the first navigation to them
+	std::unique_ptr<SettingsGUI> settingsScreen;
+	std::unique_ptr<GameGUI> gameScreen;
+	std::unique_ptr<TournamentGUI> tournamentScreen;
 
 	GameField gameField;
 
+	// declared before the advisor, which keeps pointers to them
+	NTupleNetwork valueNetwork;
+	OpeningBook openingBook;
+	MoveAdvisor moveAdvisor;
+	bool isAdviceRequested;
+	PackedBoard advisedBoard;
+
+	HintAnalyzer hintAnalyzer;
+
+	// Prepared on background threads while the main menu is shown.
+	// Declared after everything the tasks write to, so they finish first on destruction.
+	std::shared_future<TileAssets> tileAssets;
+	std::future<bool> valueNetworkLoading;
+
+	// modification time of kHeuristicWeightsFile when it was loaded last
+	std::filesystem::file_time_type heuristicWeightsTime;
+	double heuristicCheckTime;
+
+	bool isSimulationOnly;
+	double tickAccumulator;
+	double previousTickTime;
+
+	void reportStartup(const char* stage);
+	void processBackgroundLoading();
+	void applySettings();
+	void processHeuristicWeights();
+	void showMainMenu();
+	void showSettings();
+	void showGame();
+	void showTournament();
+
+	void processCurrentScreen();
 	void processMainMenu();
 	void processSettings();
 	void processGame();
+	void processTournament();
+	// Returns true if an advised movement was applied.
+	bool processAutoplay();
+	void processHints();
+	void applyMovement(UserMovement movement);
+
+	void runTicks();
+	void runSimulationTicks();
+	// Returns false if the tick had nothing to do: no animation and no movement.
+	bool tick();
 
     void initializeField();
 
@@ -32,6 +93,7 @@ public:
 	Game2048();
 
 	void run();
+	void setSimulationOnly(bool simulationOnly);
 };
 
 #endif // GAME_2048_GAME_H
@@ -0,0 +1,661 @@
+#include "game_host.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "montecarlo.h"
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Wakes the I/O loop to check for stop() even when no client is active.
+const int kHostWaitTimeoutMs = 100;
+const int kHostMaxEvents = 256;
+const std::size_t kHostReadSize = 4096;
+// Requests of a connection are not processed while its unsent responses exceed this.
+const std::size_t kHostMaxOutputSize = 1024 * sizeof(HostResponse);
+
+// epoll ids of the two descriptors that are not connections
+const std::uint64_t kListenerId = 0;
+const std::uint64_t kWakeEventId = 1;
+
+PackedBoard spawnTile(PackedBoard board, FastRandom& random) {
+	return spawnRandomTile(board, random.next());
+}
+
+}
+
+SessionPool::SessionPool() : recordCount(0), freeHead(kNoRecord), activeCount(0) {}
+
+SessionRecord* SessionPool::allocate(std::uint32_t& sessionId) {
+	std::uint32_t index = freeHead;
+	if (index != kNoRecord) {
+		freeHead = getRecord(index).nextFree;
+	}
+	else {
+		if (recordCount == kHostMaxSessions) {
+			return nullptr;
+		}
+		if (recordCount % kChunkSize == 0) {
+			chunks.push_back(std::make_unique<SessionRecord[]>(kChunkSize));
+		}
+		index = recordCount++;
+	}
+	SessionRecord& record = getRecord(index);
+	// the generation never becomes 0, so no id is ever 0
+	std::uint32_t generationMask = (1u << (32 - kSessionIndexBits)) - 1;
+	record.generation = (record.generation & generationMask) % generationMask + 1;
+	record.isActive = true;
+	record.isBusy = false;
+	activeCount++;
+	sessionId = (record.generation << kSessionIndexBits) | index;
+	return &record;
+}
+
+SessionRecord* SessionPool::find(std::uint32_t sessionId) {
+	std::uint32_t index = sessionId & (kHostMaxSessions - 1);
+	if (index >= recordCount) {
+		return nullptr;
+	}
+	SessionRecord& record = getRecord(index);
+	if (!record.isActive || record.generation != sessionId >> kSessionIndexBits) {
+		return nullptr;
+	}
+	return &record;
+}
+
+void SessionPool::release(std::uint32_t sessionId) {
+	SessionRecord* record = find(sessionId);
+	if (record == nullptr) {
+		return;
+	}
+	record->isActive = false;
+	record->nextFree = freeHead;
+	freeHead = sessionId & (kHostMaxSessions - 1);
+	activeCount--;
+}
+
+GameHost::GameHost(const IBoardEvaluator* evaluator, int threadCount) : listener(-1), epoll(-1),
+	wakeEvent(-1), nextConnectionId(kWakeEventId + 1), seedCounter(0x2048), evaluator(evaluator),
+	nextWorker(0), isStopping(false), servedCount(0) {
+	for (int i = 0; i < std::max(1, threadCount); i++) {
+		workers.push_back(std::make_unique<Worker>());
+		workers.back()->jobGeneration = 0;
+		workers.back()->pendingCount = 0;
+	}
+	for (auto& worker : workers) {
+		worker->thread = std::thread(&GameHost::workerLoop, this, std::ref(*worker));
+	}
+}
+
+void GameHost::workerLoop(Worker& worker) {
+	ExpectimaxSearch search;
+	MonteCarloPolicy monteCarlo;
+	search.setEvaluator(evaluator);
+	while (!isStopping) {
+		unsigned int generation = worker.jobGeneration.load(std::memory_order_acquire);
+		HostJob job;
+		if (!worker.jobs.tryPop(job)) {
+			worker.jobGeneration.wait(generation, std::memory_order_acquire);
+			continue;
+		}
+		SearchResult result = (AIPolicy)job.policy == AIPolicy::MonteCarlo ?
+			monteCarlo.findBestMove(job.board) : search.findBestMove(job.board, job.depth);
+		job.movement = result.bestMovement;
+		// never full: the I/O thread posts no more jobs than a channel holds
+		worker.results.tryPush(job);
+		wake();
+	}
+}
+
+void GameHost::respond(Connection& connection, const HostResponse& response) {
+	const std::uint8_t* bytes = (const std::uint8_t*)&response;
+	connection.output.insert(connection.output.end(), bytes, bytes + sizeof(response));
+	servedCount++;
+}
+
+bool GameHost::processRequest(std::uint64_t connectionId, Connection& connection, const HostRequest& request) {
+	HostResponse response{
+		.id = request.id,
+		.session = request.session,
+		.board = 0,
+		.score = 0,
+		.status = (std::uint8_t)HostStatus::Ok,
+		.movement = (std::uint8_t)UserMovement::None,
+		.reserved = 0,
+	};
+	HostCommand command = (HostCommand)request.command;
+	SessionRecord* session = nullptr;
+	if (command == HostCommand::Create) {
+		session = sessions.allocate(response.session);
+		if (session == nullptr) {
+			response.status = (std::uint8_t)HostStatus::Full;
+			respond(connection, response);
+			return true;
+		}
+		session->random = FastRandom(request.seed != 0 ? request.seed : seedCounter++);
+		session->board = spawnTile(spawnTile(0, session->random), session->random);
+		session->score = 0;
+		session->moveCount = 0;
+	}
+	else {
+		session = sessions.find(request.session);
+		if (session == nullptr) {
+			response.status = (std::uint8_t)HostStatus::UnknownSession;
+			respond(connection, response);
+			return true;
+		}
+		if (session->isBusy) {
+			response.status = (std::uint8_t)HostStatus::Busy;
+			respond(connection, response);
+			return true;
+		}
+	}
+	response.board = session->board;
+	response.score = session->score;
+
+	switch (command) {
+	case HostCommand::Create:
+	case HostCommand::Get:
+		break;
+	case HostCommand::Close:
+		sessions.release(request.session);
+		respond(connection, response);
+		return true;
+	case HostCommand::Move: {
+		UserMovement movement = (UserMovement)request.argument;
+		if (movement < UserMovement::Left || movement > UserMovement::Down) {
+			response.status = (std::uint8_t)HostStatus::BadRequest;
+			respond(connection, response);
+			return true;
+		}
+		int scoreGained = 0;
+		PackedBoard movedBoard = moveBoard(session->board, movement, &scoreGained);
+		if (movedBoard == session->board) {
+			response.status = (std::uint8_t)HostStatus::NotMoved;
+			break;
+		}
+		session->board = spawnTile(movedBoard, session->random);
+		session->score += scoreGained;
+		session->moveCount++;
+		response.board = session->board;
+		response.score = session->score;
+		response.movement = (std::uint8_t)movement;
+		break;
+	}
+	case HostCommand::AIMove: {
+		if (isBoardFailed(session->board)) {
+			break;
+		}
+		// round robin over the workers that still have room
+		for (std::size_t i = 0; i < workers.size(); i++) {
+			Worker& worker = *workers[(nextWorker + i) % workers.size()];
+			if (worker.pendingCount == kJobQueueSize) {
+				continue;
+			}
+			int depth = request.depth == 0 ? kDefaultSearchDepth : request.depth;
+			worker.jobs.tryPush(HostJob{
+				.connection = connectionId,
+				.requestId = request.id,
+				.session = request.session,
+				.board = session->board,
+				.policy = request.argument,
+				.depth = (std::uint8_t)std::min(depth, kHostMaxDepth),
+				.movement = UserMovement::None,
+			});
+			worker.pendingCount++;
+			worker.jobGeneration.fetch_add(1, std::memory_order_release);
+			worker.jobGeneration.notify_one();
+			nextWorker = (nextWorker + i + 1) % workers.size();
+			session->isBusy = true;
+			return true;
+		}
+		return false;
+	}
+	default:
+		response.status = (std::uint8_t)HostStatus::BadRequest;
+		respond(connection, response);
+		return true;
+	}
+	if (response.status == (std::uint8_t)HostStatus::Ok && isBoardFailed(session->board)) {
+		response.status = (std::uint8_t)HostStatus::GameOver;
+	}
+	respond(connection, response);
+	return true;
+}
+
+// Moves chosen by the workers are applied here, on the I/O thread.
+void GameHost::collectResults() {
+	bool isCollected = false;
+	for (auto& worker : workers) {
+		HostJob job;
+		while (worker->results.tryPop(job)) {
+			worker->pendingCount--;
+			isCollected = true;
+			SessionRecord* session = sessions.find(job.session);
+			if (session == nullptr) {
+				continue;
+			}
+			session->isBusy = false;
+			HostResponse response{
+				.id = job.requestId,
+				.session = job.session,
+				.board = session->board,
+				.score = session->score,
+				.status = (std::uint8_t)HostStatus::Ok,
+				.movement = (std::uint8_t)job.movement,
+				.reserved = 0,
+			};
+			int scoreGained = 0;
+			PackedBoard movedBoard = job.movement == UserMovement::None ?
+				session->board : moveBoard(session->board, job.movement, &scoreGained);
+			if (movedBoard != session->board) {
+				session->board = spawnTile(movedBoard, session->random);
+				session->score += scoreGained;
+				session->moveCount++;
+				response.board = session->board;
+				response.score = session->score;
+			}
+			if (isBoardFailed(session->board)) {
+				response.status = (std::uint8_t)HostStatus::GameOver;
+			}
+			auto connection = connections.find(job.connection);
+			if (connection == connections.end()) {
+				continue;
+			}
+			respond(connection->second, response);
+			queueConnection(job.connection, connection->second);
+		}
+	}
+	if (!isCollected) {
+		return;
+	}
+	// there is room in the worker queues again
+	for (std::uint64_t id : blockedConnections) {
+		auto connection = connections.find(id);
+		if (connection != connections.end()) {
+			connection->second.isReadPaused = false;
+			updateWatchedEvents(id, connection->second);
+			queueConnection(id, connection->second);
+		}
+	}
+	blockedConnections.clear();
+}
+
+#ifdef __linux__
+
+GameHost::~GameHost() {
+	isStopping = true;
+	for (auto& worker : workers) {
+		worker->jobGeneration.fetch_add(1);
+		worker->jobGeneration.notify_one();
+		worker->thread.join();
+	}
+	for (auto& [connectionId, connection] : connections) {
+		::close(connection.socket);
+	}
+	if (listener >= 0) {
+		::close(listener);
+		unlink(socketPath.c_str());
+	}
+	if (epoll >= 0) {
+		::close(epoll);
+	}
+	if (wakeEvent >= 0) {
+		::close(wakeEvent);
+	}
+}
+
+void GameHost::stop() {
+	isStopping = true;
+	wake();
+}
+
+void GameHost::wake() {
+	if (wakeEvent >= 0) {
+		std::uint64_t one = 1;
+		[[maybe_unused]] ssize_t size = write(wakeEvent, &one, sizeof(one));
+	}
+}
+
+bool GameHost::open(const std::string& path) {
+	sockaddr_un address{};
+	if (path.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+	listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listener < 0) {
+		return false;
+	}
+	unlink(path.c_str());
+	if (bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+		::close(listener);
+		listener = -1;
+		return false;
+	}
+	socketPath = path;
+
+	epoll = epoll_create1(EPOLL_CLOEXEC);
+	wakeEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (epoll < 0 || wakeEvent < 0) {
+		return false;
+	}
+	epoll_event listenerEvent{ .events = EPOLLIN, .data = { .u64 = kListenerId } };
+	epoll_event wakeEventEvent{ .events = EPOLLIN, .data = { .u64 = kWakeEventId } };
+	return epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &listenerEvent) == 0 &&
+	       epoll_ctl(epoll, EPOLL_CTL_ADD, wakeEvent, &wakeEventEvent) == 0;
+}
+
+void GameHost::acceptConnections() {
+	while (true) {
+		int clientSocket = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (clientSocket < 0) {
+			return;
+		}
+		std::uint64_t connectionId = nextConnectionId++;
+		epoll_event event{ .events = EPOLLIN | EPOLLRDHUP, .data = { .u64 = connectionId } };
+		if (epoll_ctl(epoll, EPOLL_CTL_ADD, clientSocket, &event) != 0) {
+			::close(clientSocket);
+			continue;
+		}
+		connections.emplace(connectionId, Connection{
+			.socket = clientSocket,
+			.input = {},
+			.output = {},
+			.isWriteWatched = false,
+			.isReadPaused = false,
+			.isOutputFull = false,
+			.isQueued = false,
+		});
+	}
+}
+
+void GameHost::queueConnection(std::uint64_t connectionId, Connection& connection) {
+	if (!connection.isQueued) {
+		connection.isQueued = true;
+		readyConnections.push_back(connectionId);
+	}
+}
+
+bool GameHost::readInput(Connection& connection) {
+	std::vector<std::uint8_t>& input = connection.input;
+	while (true) {
+		std::size_t oldSize = input.size();
+		input.resize(oldSize + kHostReadSize);
+		ssize_t readSize = recv(connection.socket, input.data() + oldSize, kHostReadSize, 0);
+		input.resize(oldSize + std::max<ssize_t>(readSize, 0));
+		if (readSize == 0) {
+			return false;
+		}
+		if (readSize < 0) {
+			return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+		}
+	}
+}
+
+bool GameHost::writeOutput(std::uint64_t connectionId, Connection& connection) {
+	std::size_t writtenSize = 0;
+	while (writtenSize < connection.output.size()) {
+		ssize_t sentSize = send(connection.socket, connection.output.data() + writtenSize,
+		                        connection.output.size() - writtenSize, MSG_NOSIGNAL);
+		if (sentSize < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+				break;
+			}
+			return false;
+		}
+		writtenSize += (std::size_t)sentSize;
+	}
+	connection.output.erase(connection.output.begin(), connection.output.begin() + writtenSize);
+	// EPOLLOUT is only watched while the socket buffer is full
+	bool shouldWatchWrite = !connection.output.empty();
+	bool isOutputFull = connection.output.size() >= kHostMaxOutputSize;
+	if (!isOutputFull && !connection.isReadPaused && connection.input.size() >= sizeof(HostRequest)) {
+		// requests left behind by a full output are processed again
+		queueConnection(connectionId, connection);
+	}
+	if (shouldWatchWrite != connection.isWriteWatched || isOutputFull != connection.isOutputFull) {
+		connection.isWriteWatched = shouldWatchWrite;
+		connection.isOutputFull = isOutputFull;
+		updateWatchedEvents(connectionId, connection);
+	}
+	return true;
+}
+
+void GameHost::updateWatchedEvents(std::uint64_t connectionId, Connection& connection) {
+	// a hangup is still reported while reading is paused, EPOLLHUP is always watched
+	epoll_event event{
+		.events = (connection.isReadPaused || connection.isOutputFull ? 0u : EPOLLIN | EPOLLRDHUP) |
+		          (connection.isWriteWatched ? EPOLLOUT : 0u),
+		.data = { .u64 = connectionId },
+	};
+	epoll_ctl(epoll, EPOLL_CTL_MOD, connection.socket, &event);
+}
+
+void GameHost::closeConnection(std::uint64_t connectionId) {
+	auto connection = connections.find(connectionId);
+	if (connection == connections.end()) {
+		return;
+	}
+	// closing also removes the socket from the epoll set
+	::close(connection->second.socket);
+	connections.erase(connection);
+}
+
+bool GameHost::run() {
+	if (listener < 0 || epoll < 0) {
+		return false;
+	}
+	epoll_event events[kHostMaxEvents];
+	std::vector<std::uint64_t> closedConnections;
+	while (!isStopping) {
+		// connections queued by the previous loop must not wait for new events
+		int timeout = readyConnections.empty() ? kHostWaitTimeoutMs : 0;
+		int eventCount = epoll_wait(epoll, events, kHostMaxEvents, timeout);
+		if (eventCount < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		closedConnections.clear();
+		for (int i = 0; i < eventCount; i++) {
+			std::uint64_t id = events[i].data.u64;
+			if (id == kListenerId) {
+				acceptConnections();
+				continue;
+			}
+			if (id == kWakeEventId) {
+				std::uint64_t wakeCount;
+				[[maybe_unused]] ssize_t size = read(wakeEvent, &wakeCount, sizeof(wakeCount));
+				continue;
+			}
+			auto connection = connections.find(id);
+			if (connection == connections.end()) {
+				continue;
+			}
+			bool isOpen = true;
+			if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+				isOpen = readInput(connection->second);
+			}
+			if (isOpen && (events[i].events & EPOLLOUT)) {
+				isOpen = writeOutput(id, connection->second);
+			}
+			if (isOpen) {
+				queueConnection(id, connection->second);
+			}
+			else {
+				closedConnections.push_back(id);
+			}
+		}
+		for (std::uint64_t id : closedConnections) {
+			closeConnection(id);
+		}
+		collectResults();
+
+		// whole records only, a partial one stays in the buffer until the rest arrives
+		std::vector<std::uint64_t> queuedConnections;
+		queuedConnections.swap(readyConnections);
+		for (std::uint64_t id : queuedConnections) {
+			auto found = connections.find(id);
+			if (found == connections.end()) {
+				continue;
+			}
+			Connection& connection = found->second;
+			connection.isQueued = false;
+			std::size_t offset = 0;
+			while (connection.output.size() < kHostMaxOutputSize &&
+			       connection.input.size() - offset >= sizeof(HostRequest)) {
+				HostRequest request;
+				std::memcpy(&request, connection.input.data() + offset, sizeof(request));
+				if (!processRequest(id, connection, request)) {
+					// unread requests stay in the socket until the workers catch up
+					if (!connection.isReadPaused) {
+						connection.isReadPaused = true;
+						updateWatchedEvents(id, connection);
+						blockedConnections.push_back(id);
+					}
+					break;
+				}
+				offset += sizeof(request);
+			}
+			connection.input.erase(connection.input.begin(), connection.input.begin() + offset);
+			if (!writeOutput(id, connection)) {
+				closeConnection(id);
+			}
+		}
+	}
+	return true;
+}
+
+GameHostClient::GameHostClient() : socket(-1) {
+}
+
+GameHostClient::~GameHostClient() {
+	close();
+}
+
+bool GameHostClient::connect(const std::string& path) {
+	close();
+	sockaddr_un address{};
+	if (path.size() >= sizeof(address.sun_path)) {
+		return false;
+	}
+	address.sun_family = AF_UNIX;
+	std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+	socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (socket < 0) {
+		return false;
+	}
+	if (::connect(socket, (const sockaddr*)&address, sizeof(address)) != 0) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void GameHostClient::close() {
+	if (socket >= 0) {
+		::close(socket);
+		socket = -1;
+	}
+}
+
+bool GameHostClient::sendRequests(const HostRequest* requests, HostResponse* responses, int count) {
+	if (socket < 0) {
+		return false;
+	}
+	std::size_t requestSize = sizeof(HostRequest) * count;
+	for (std::size_t sentSize = 0; sentSize < requestSize;) {
+		ssize_t size = send(socket, (const std::uint8_t*)requests + sentSize, requestSize - sentSize, MSG_NOSIGNAL);
+		if (size <= 0) {
+			return false;
+		}
+		sentSize += (std::size_t)size;
+	}
+	std::size_t responseSize = sizeof(HostResponse) * count;
+	for (std::size_t receivedSize = 0; receivedSize < responseSize;) {
+		ssize_t size = recv(socket, (std::uint8_t*)responses + receivedSize, responseSize - receivedSize, 0);
+		if (size <= 0) {
+			return false;
+		}
+		receivedSize += (std::size_t)size;
+	}
+	return true;
+}
+
+#else
+
+GameHost::~GameHost() {
+	isStopping = true;
+	for (auto& worker : workers) {
+		worker->jobGeneration.fetch_add(1);
+		worker->jobGeneration.notify_one();
+		worker->thread.join();
+	}
+}
+
+void GameHost::stop() {
+	isStopping = true;
+}
+
+void GameHost::wake() {
+}
+
+bool GameHost::open(const std::string&) {
+	return false;
+}
+
+void GameHost::acceptConnections() {
+}
+
+void GameHost::queueConnection(std::uint64_t, Connection&) {
+}
+
+void GameHost::updateWatchedEvents(std::uint64_t, Connection&) {
+}
+
+bool GameHost::readInput(Connection&) {
+	return false;
+}
+
+bool GameHost::writeOutput(std::uint64_t, Connection&) {
+	return false;
+}
+
+void GameHost::closeConnection(std::uint64_t) {
+}
+
+bool GameHost::run() {
+	return false;
+}
+
+GameHostClient::GameHostClient() : socket(-1) {
+}
+
+GameHostClient::~GameHostClient() {
+}
+
+bool GameHostClient::connect(const std::string&) {
+	return false;
+}
+
+void GameHostClient::close() {
+}
+
+bool GameHostClient::sendRequests(const HostRequest*, HostResponse*, int) {
+	return false;
+}
+
+#endif
@@ -0,0 +1,234 @@
+#ifndef GAME_2048_GAME_HOST_H
+#define GAME_2048_GAME_HOST_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "board.h"
+#include "channel.h"
+#include "search.h"
+
+/*
+	Binary protocol of the game host, in the host byte order like the advice server:
+	 - request (16 bytes): id, HostCommand, argument (UserMovement of Move, AIPolicy of AIMove),
+	   search depth of AIMove (0 - server default), session id (not used by Create),
+	   seed of Create (0 - picked by the host);
+	 - response (24 bytes): id of the request, session id, board after the command, score,
+	   HostStatus and the movement that was made (None if there was none).
+	Requests of one connection are answered in order, except AIMove, which is answered
+	when its search is done. A session is not tied to a connection, a player may reconnect.
+*/
+enum class HostCommand : std::uint8_t {
+	Create = 0,
+	Move,
+	AIMove,
+	Get,
+	Close
+};
+
+enum class HostStatus : std::uint8_t {
+	Ok = 0,
+	NotMoved, // the movement didn't change the board
+	GameOver, // after the command there is no movement left
+	UnknownSession,
+	Busy, // an AIMove of the session is still searched
+	Full, // no free session records
+	BadRequest
+};
+
+struct HostRequest {
+	std::uint32_t id;
+	std::uint8_t command;
+	std::uint8_t argument;
+	std::uint8_t depth;
+	std::uint8_t reserved;
+	std::uint32_t session;
+	std::uint32_t seed;
+};
+
+struct HostResponse {
+	std::uint32_t id;
+	std::uint32_t session;
+	std::uint64_t board;
+	std::int32_t score;
+	std::uint8_t status;
+	std::uint8_t movement;
+	std::uint16_t reserved;
+};
+
+static_assert(sizeof(HostRequest) == 16 && sizeof(HostResponse) == 24, "Unexpected host record sizes");
+
+const char* const kHostSocketPath = "/tmp/game_2048_host.sock";
+const int kHostMaxDepth = 6;
+// Session ids keep the record index in the low bits and a reuse counter in the high bits.
+const int kSessionIndexBits = 20;
+const std::uint32_t kHostMaxSessions = 1u << kSessionIndexBits;
+
+// One game: a few words instead of a GameField with its 5 KB mt19937.
+struct SessionRecord {
+	PackedBoard board;
+	FastRandom random = FastRandom(1);
+	std::int32_t score;
+	std::int32_t moveCount;
+	std::uint32_t generation; // bumped on every reuse of the record, 0 - never used
+	std::uint32_t nextFree; // index of the next free record, while the record is free
+	bool isActive;
+	bool isBusy;
+};
+
+static_assert(sizeof(SessionRecord) <= 40, "Session records should stay small");
+
+/*
+	Fixed-size session records allocated from chunks that are never moved or freed,
+	so a record pointer stays valid for the life of the pool. Released records go to
+	an intrusive free list and are reused first. Not thread-safe.
+*/
+class SessionPool {
+private:
+	static const std::uint32_t kChunkSize = 4096;
+	static const std::uint32_t kNoRecord = UINT32_MAX;
+
+	std::vector<std::unique_ptr<SessionRecord[]>> chunks;
+	std::uint32_t recordCount;
+	std::uint32_t freeHead;
+	std::uint32_t activeCount;
+
+	SessionRecord& getRecord(std::uint32_t index) { return chunks[index / kChunkSize][index % kChunkSize]; }
+
+public:
+	SessionPool();
+
+	// nullptr if all kHostMaxSessions records are in use.
+	SessionRecord* allocate(std::uint32_t& sessionId);
+	// nullptr for ids of released or never allocated records.
+	SessionRecord* find(std::uint32_t sessionId);
+	void release(std::uint32_t sessionId);
+	std::uint32_t getActiveCount() const { return activeCount; }
+};
+
+/*
+	Hosts many independent games for remote players on a Unix domain socket:
+	 - one I/O thread runs an epoll loop over all connections and applies the cheap commands
+	   (Create, Move, Get, Close) itself, so sessions are only ever changed by this thread;
+	 - AIMove searches a snapshot of the board on a worker; jobs and results go through a pair
+	   of single producer channels per worker, and an eventfd wakes the loop for the results;
+	 - when every worker queue is full, a connection is removed from EPOLLIN until they drain,
+	   so its requests wait in the socket buffer and the client blocks on a full socket;
+	 - the same happens while a connection holds more unsent responses than a cap,
+	   so a client that sends cheap commands and never reads cannot grow its output.
+	Linux only, open() fails elsewhere.
+*/
+class GameHost {
+private:
+	static const std::size_t kJobQueueSize = 256;
+
+	struct Connection {
+		int socket;
+		std::vector<std::uint8_t> input;
+		std::vector<std::uint8_t> output;
+		bool isWriteWatched;
+		bool isReadPaused; // in 'blockedConnections', EPOLLIN is not watched
+		bool isOutputFull; // EPOLLIN is not watched until writeOutput() drains the output
+		bool isQueued; // in 'readyConnections' of the current loop
+	};
+
+	struct HostJob {
+		std::uint64_t connection;
+		std::uint32_t requestId;
+		std::uint32_t session;
+		PackedBoard board;
+		std::uint8_t policy;
+		std::uint8_t depth;
+		UserMovement movement;
+	};
+
+	struct Worker {
+		SpscChannel<HostJob, kJobQueueSize> jobs;
+		SpscChannel<HostJob, kJobQueueSize> results;
+		// Incremented with every posted job, the worker sleeps on it while idle.
+		std::atomic<unsigned int> jobGeneration;
+		// Jobs posted and not yet collected, only used by the I/O thread.
+		std::size_t pendingCount;
+		std::thread thread;
+	};
+
+	int listener;
+	int epoll;
+	int wakeEvent;
+	std::string socketPath;
+
+	std::unordered_map<std::uint64_t, Connection> connections;
+	std::uint64_t nextConnectionId;
+	std::vector<std::uint64_t> readyConnections;
+	// waiting for room in the worker queues
+	std::vector<std::uint64_t> blockedConnections;
+
+	SessionPool sessions;
+	std::uint64_t seedCounter;
+
+	const IBoardEvaluator* evaluator;
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::size_t nextWorker;
+	std::atomic<bool> isStopping;
+
+	long long servedCount;
+
+	void workerLoop(Worker& worker);
+	void wake();
+	void acceptConnections();
+	void queueConnection(std::uint64_t connectionId, Connection& connection);
+	// Applies isReadPaused, isOutputFull and isWriteWatched to the epoll set.
+	void updateWatchedEvents(std::uint64_t connectionId, Connection& connection);
+	// Returns false if the connection is closed or broken.
+	bool readInput(Connection& connection);
+	bool writeOutput(std::uint64_t connectionId, Connection& connection);
+	void closeConnection(std::uint64_t connectionId);
+	// Returns false if the request has to wait for a free worker.
+	bool processRequest(std::uint64_t connectionId, Connection& connection, const HostRequest& request);
+	void collectResults();
+	void respond(Connection& connection, const HostResponse& response);
+
+public:
+	// nullptr evaluator means evaluateBoard(). The evaluator must outlive the host.
+	GameHost(const IBoardEvaluator* evaluator, int threadCount);
+	~GameHost();
+
+	GameHost(const GameHost&) = delete;
+	GameHost& operator=(const GameHost&) = delete;
+
+	// Replaces a stale socket file left by a previous run.
+	bool open(const std::string& path);
+	// Serves until stop() is called, returns false on a socket error.
+	bool run();
+	// Safe to call from a signal handler.
+	void stop();
+	long long getServedCount() const { return servedCount; }
+	std::uint32_t getSessionCount() const { return sessions.getActiveCount(); }
+};
+
+// Blocking client of GameHost.
+class GameHostClient {
+private:
+	int socket;
+
+public:
+	GameHostClient();
+	~GameHostClient();
+
+	GameHostClient(const GameHostClient&) = delete;
+	GameHostClient& operator=(const GameHostClient&) = delete;
+
+	bool connect(const std::string& path);
+	void close();
+
+	// Sends all requests first and then collects one response per request. Responses
+	// arrive in the request order, except that AIMove responses may come later.
+	bool sendRequests(const HostRequest* requests, HostResponse* responses, int count);
+};
+
+#endif // GAME_2048_GAME_HOST_H
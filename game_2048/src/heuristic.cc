@@ -0,0 +1,131 @@
+#include "heuristic.h"
+
+#include <cmath>
+#include <fstream>
+
+#include "config_file.h"
+
+namespace {
+
+float computeRowValue(PackedRow row, const HeuristicWeights& weights) {
+	int cells[4] = { row & 0xF, (row >> 4) & 0xF, (row >> 8) & 0xF, (row >> 12) & 0xF };
+	float sum = 0;
+	int emptyCount = 0;
+	int mergeCount = 0;
+	int previous = 0;
+	int sameCount = 0;
+	for (int i = 0; i < 4; i++) {
+		sum += std::pow((float)cells[i], weights.sumPower);
+		if (cells[i] == 0) {
+			emptyCount++;
+			continue;
+		}
+		if (previous == cells[i]) {
+			sameCount++;
+		}
+		else if (sameCount > 0) {
+			mergeCount += 1 + sameCount;
+			sameCount = 0;
+		}
+		previous = cells[i];
+	}
+	if (sameCount > 0) {
+		mergeCount += 1 + sameCount;
+	}
+	float monotonicityLeft = 0;
+	float monotonicityRight = 0;
+	for (int i = 1; i < 4; i++) {
+		float previousRank = std::pow((float)cells[i - 1], weights.monotonicityPower);
+		float currentRank = std::pow((float)cells[i], weights.monotonicityPower);
+		if (cells[i - 1] > cells[i]) {
+			monotonicityLeft += previousRank - currentRank;
+		}
+		else {
+			monotonicityRight += currentRank - previousRank;
+		}
+	}
+	return weights.base + weights.empty * emptyCount + weights.merges * mergeCount -
+	       weights.monotonicity * std::fmin(monotonicityLeft, monotonicityRight) - weights.sum * sum;
+}
+
+float* findWeight(HeuristicWeights& weights, const std::string& name) {
+	if (name == "base") return &weights.base;
+	if (name == "empty") return &weights.empty;
+	if (name == "merges") return &weights.merges;
+	if (name == "monotonicity_power") return &weights.monotonicityPower;
+	if (name == "monotonicity") return &weights.monotonicity;
+	if (name == "sum_power") return &weights.sumPower;
+	if (name == "sum") return &weights.sum;
+	return nullptr;
+}
+
+}
+
+bool loadHeuristicWeights(const std::string& path, HeuristicWeights& weights) {
+	HeuristicWeights newWeights = weights;
+	bool isRead = readConfigFile(path, [&newWeights](const std::string& name, std::istream& value) {
+		float* weight = findWeight(newWeights, name);
+		return weight != nullptr && (value >> *weight) && std::isfinite(*weight);
+	});
+	if (isRead) {
+		weights = newWeights;
+	}
+	return isRead;
+}
+
+bool saveHeuristicWeights(const std::string& path, const HeuristicWeights& weights) {
+	std::ofstream file(path);
+	file << "base " << weights.base << "\n"
+	     << "empty " << weights.empty << "\n"
+	     << "merges " << weights.merges << "\n"
+	     << "monotonicity_power " << weights.monotonicityPower << "\n"
+	     << "monotonicity " << weights.monotonicity << "\n"
+	     << "sum_power " << weights.sumPower << "\n"
+	     << "sum " << weights.sum << "\n";
+	return (bool)file;
+}
+
+RowHeuristic::RowHeuristic(const HeuristicWeights& initialWeights) : currentTable(nullptr) {
+	setWeights(initialWeights);
+}
+
+float RowHeuristic::evaluate(PackedBoard board) const {
+	const float* table = currentTable.load(std::memory_order_acquire);
+	PackedBoard transposed = transposeBoard(board);
+	float value = 0;
+	for (int i = 0; i < 4; i++) {
+		value += table[getBoardRow(board, i)];
+		value += table[getBoardRow(transposed, i)];
+	}
+	return value;
+}
+
+HeuristicWeights RowHeuristic::getWeights() {
+	std::lock_guard<std::mutex> lock(weightsMutex);
+	return weights;
+}
+
+void RowHeuristic::setWeights(const HeuristicWeights& newWeights) {
+	auto table = std::make_unique<float[]>(kRowCount);
+	for (int row = 0; row < kRowCount; row++) {
+		table[row] = computeRowValue((PackedRow)row, newWeights);
+	}
+	std::lock_guard<std::mutex> lock(weightsMutex);
+	weights = newWeights;
+	currentTable.store(table.get(), std::memory_order_release);
+	tables.push_back(std::move(table));
+}
+
+bool RowHeuristic::loadWeights(const std::string& path) {
+	HeuristicWeights newWeights = getWeights();
+	if (!loadHeuristicWeights(path, newWeights)) {
+		return false;
+	}
+	setWeights(newWeights);
+	return true;
+}
+
+RowHeuristic& getDefaultHeuristic() {
+	static RowHeuristic heuristic;
+	return heuristic;
+}
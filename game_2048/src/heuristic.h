@@ -0,0 +1,66 @@
+#ifndef GAME_2048_HEURISTIC_H
+#define GAME_2048_HEURISTIC_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "search.h"
+
+// Weights file that the game reloads whenever it changes, if it exists.
+const std::string kHeuristicWeightsFile = "heuristic_weights.txt";
+
+// Terms of the value of one row (or column), the defaults are the tuned values.
+struct HeuristicWeights {
+	float base = 200000.0f;
+	float empty = 270.0f;
+	float merges = 700.0f;
+	float monotonicityPower = 4.0f;
+	float monotonicity = 47.0f;
+	float sumPower = 3.5f;
+	float sum = 11.0f;
+};
+
+// A readConfigFile() file of weight names, weights not in the file keep their values.
+bool loadHeuristicWeights(const std::string& path, HeuristicWeights& weights);
+bool saveHeuristicWeights(const std::string& path, const HeuristicWeights& weights);
+
+/*
+	Every heuristic term only depends on the tiles of one line, so the value of
+	all 65536 rows is computed once per weights, and a board is evaluated with
+	4 row and 4 column lookups in a 256 KB table.
+	Weights may be replaced while searches are running: a new table is built
+	aside and published atomically, the replaced tables are kept until destruction
+	because a search may still read them (weights change rarely).
+*/
+class RowHeuristic : public IBoardEvaluator {
+private:
+	std::mutex weightsMutex;
+	HeuristicWeights weights;
+	std::vector<std::unique_ptr<float[]>> tables;
+	std::atomic<const float*> currentTable;
+
+public:
+	explicit RowHeuristic(const HeuristicWeights& initialWeights = HeuristicWeights{});
+
+	RowHeuristic(const RowHeuristic&) = delete;
+	RowHeuristic& operator=(const RowHeuristic&) = delete;
+
+	float evaluateRow(PackedRow row) const {
+		return currentTable.load(std::memory_order_acquire)[row];
+	}
+	virtual float evaluate(PackedBoard board) const;
+
+	HeuristicWeights getWeights();
+	void setWeights(const HeuristicWeights& newWeights);
+	// Keeps the current weights if the file can't be read.
+	bool loadWeights(const std::string& path);
+};
+
+// Used by evaluateBoard().
+RowHeuristic& getDefaultHeuristic();
+
+#endif // GAME_2048_HEURISTIC_H
@@ -0,0 +1,154 @@
+#include "hint.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "search.h"
+#include "symmetry.h"
+
+// The cache is kept between moves, but dropped once it grows past this size.
+const std::size_t kHintCacheLimit = 1 << 18;
+const long long kDeadlineCheckInterval = 16;
+
+double getHintFrameBudget(int framerate) {
+	if (framerate <= 0) {
+		framerate = *std::max_element(std::begin(kFramerateOptions), std::end(kFramerateOptions));
+	}
+	return kHintFrameShare / framerate;
+}
+
+HintAnalyzer::HintAnalyzer() : board(0), hasBoard(false), hints{}, completedDepth(0), 
+	currentDepth(1), currentDirection(0), pendingHints{}, nodeCount(0), 
+	isOutOfTime(false) {
+	// rehashing a big table takes longer than a whole frame budget
+	cache.reserve(kHintCacheLimit);
+}
+
+void HintAnalyzer::setBoard(PackedBoard newBoard) {
+	if (hasBoard && board == newBoard) {
+		return;
+	}
+	board = newBoard;
+	hasBoard = true;
+	for (auto& hint : hints) {
+		hint = MovementHint{};
+	}
+	completedDepth = 0;
+	currentDepth = 1;
+	currentDirection = 0;
+	if (cache.size() > kHintCacheLimit) {
+		cache.clear();
+	}
+}
+
+bool HintAnalyzer::advance(double budgetSeconds) {
+	if (!hasBoard || completedDepth == kHintMaxDepth) {
+		return false;
+	}
+	deadline = std::chrono::steady_clock::now() + 
+		std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(budgetSeconds));
+	nodeCount = 0;
+	isOutOfTime = false;
+	bool isPublished = false;
+	while (completedDepth < kHintMaxDepth) {
+		UserMovement movement = (UserMovement)(currentDirection + 1);
+		int moveScore = 0;
+		PackedBoard movedBoard = moveBoard(board, movement, &moveScore);
+		MovementHint hint{};
+		if (movedBoard != board) {
+			NodeValue value = evaluateSpawn(movedBoard, currentDepth);
+			if (isOutOfTime) {
+				// this direction is restarted on the next call, finished subtrees stay cached
+				break;
+			}
+			hint = MovementHint{
+				.isAvailable = true,
+				.value = value.heuristic,
+				.expectedScore = moveScore + value.expectedScore,
+				.survivalChance = value.survivalChance,
+			};
+		}
+		pendingHints[currentDirection] = hint;
+		currentDirection++;
+		if (currentDirection == 4) {
+			for (int i = 0; i < 4; i++) {
+				hints[i] = pendingHints[i];
+			}
+			completedDepth = currentDepth;
+			currentDepth++;
+			currentDirection = 0;
+			isPublished = true;
+		}
+	}
+	return isPublished;
+}
+
+bool HintAnalyzer::checkDeadline() {
+	nodeCount++;
+	if (!isOutOfTime && (nodeCount % kDeadlineCheckInterval) == 0) {
+		isOutOfTime = std::chrono::steady_clock::now() >= deadline;
+	}
+	return isOutOfTime;
+}
+
+HintAnalyzer::NodeValue HintAnalyzer::evaluateMove(PackedBoard board, int depth) {
+	if (depth == 0) {
+		return NodeValue{ .heuristic = evaluateBoard(board), .expectedScore = 0,
+		                  .survivalChance = isBoardFailed(board) ? 0.0f : 1.0f };
+	}
+	NodeValue best{ .heuristic = 0, .expectedScore = 0, .survivalChance = 0 };
+	bool hasMove = false;
+	for (int i = (int)UserMovement::Left; i <= (int)UserMovement::Down; i++) {
+		int moveScore = 0;
+		PackedBoard movedBoard = moveBoard(board, (UserMovement)i, &moveScore);
+		if (movedBoard == board) {
+			continue;
+		}
+		NodeValue value = evaluateSpawn(movedBoard, depth);
+		if (isOutOfTime) {
+			return best;
+		}
+		value.expectedScore += moveScore;
+		if (!hasMove || value.heuristic > best.heuristic) {
+			best = value;
+			hasMove = true;
+		}
+	}
+	return best;
+}
+
+HintAnalyzer::NodeValue HintAnalyzer::evaluateSpawn(PackedBoard board, int depth) {
+	NodeValue result{ .heuristic = 0, .expectedScore = 0, .survivalChance = 0 };
+	if (checkDeadline()) {
+		return result;
+	}
+	PackedBoard cacheKey = canonicalizeBoard(board).board;
+	unsigned int depthBit = 1u << (depth - 1);
+	auto cached = cache.find(cacheKey);
+	if (cached != cache.end() && (cached->second.depthMask & depthBit) != 0) {
+		return cached->second.values[depth - 1];
+	}
+	int emptyCount = countEmptyTiles(board);
+	for (int y = 0; y < 4; y++) {
+		for (int x = 0; x < 4; x++) {
+			if (getBoardTile(board, x, y) != GameTileType::NoTile) {
+				continue;
+			}
+			NodeValue value2 = evaluateMove(setBoardTile(board, x, y, GameTileType::Tile2), depth - 1);
+			NodeValue value4 = evaluateMove(setBoardTile(board, x, y, GameTileType::Tile4), depth - 1);
+			if (isOutOfTime) {
+				return result;
+			}
+			float weight2 = (1.0f - kTile4SpawnProbability) / emptyCount;
+			float weight4 = kTile4SpawnProbability / emptyCount;
+			result.heuristic += weight2 * value2.heuristic + weight4 * value4.heuristic;
+			result.expectedScore += weight2 * value2.expectedScore + weight4 * value4.expectedScore;
+			result.survivalChance += weight2 * value2.survivalChance + weight4 * value4.survivalChance;
+		}
+	}
+	CacheEntry& entry = cache.try_emplace(cacheKey, CacheEntry{ .depthMask = 0, .values = {} }).first->second;
+	entry.depthMask |= depthBit;
+	entry.values[depth - 1] = result;
+	return result;
+}
@@ -0,0 +1,77 @@
+#ifndef GAME_2048_HINT_H
+#define GAME_2048_HINT_H
+
+#include <chrono>
+#include <unordered_map>
+
+#include "board.h"
+#include "window.h"
+
+// Deepest look-ahead of the hint analysis, in player moves.
+const int kHintMaxDepth = 4;
+// Part of every rendered frame given to the hint analysis.
+const double kHintFrameShare = 0.25;
+
+// Seconds of hint analysis per frame at the framerate setting. Uncapped frames
+// get the share of a frame at the fastest capped option.
+double getHintFrameBudget(int framerate);
+
+/*
+	Per-direction move evaluation that is spread over many frames:
+	 - advance() works only until its time budget runs out and continues from
+	   there on the next call;
+	 - directions are evaluated with iterative deepening, every finished depth
+	   is published to getHints();
+	 - evaluated positions are kept between moves, so after a move most of the
+	   new position was already searched as a part of the previous one.
+*/
+class HintAnalyzer {
+private:
+	struct NodeValue {
+		float heuristic;
+		float expectedScore;
+		float survivalChance;
+	};
+
+	// Values of one board at every depth that was searched. Only the exact depth is reused,
+	// expected score and survival chance of different depths can't be compared.
+	struct CacheEntry {
+		unsigned int depthMask; // bit 'depth - 1'
+		NodeValue values[kHintMaxDepth];
+	};
+
+	PackedBoard board;
+	bool hasBoard;
+
+	MovementHint hints[4];
+	int completedDepth;
+
+	int currentDepth;
+	int currentDirection;
+	MovementHint pendingHints[4];
+
+	std::unordered_map<PackedBoard, CacheEntry> cache;
+
+	std::chrono::steady_clock::time_point deadline;
+	long long nodeCount;
+	bool isOutOfTime;
+
+	bool checkDeadline();
+	NodeValue evaluateMove(PackedBoard board, int depth);
+	NodeValue evaluateSpawn(PackedBoard board, int depth);
+
+public:
+	HintAnalyzer();
+
+	void setBoard(PackedBoard newBoard);
+	PackedBoard getBoard() const { return board; }
+
+	// Returns true if new hints were published during this call.
+	bool advance(double budgetSeconds);
+
+	// Hints for Left, Right, Up, Down (UserMovement value - 1).
+	const MovementHint* getHints() const { return hints; }
+	int getCompletedDepth() const { return completedDepth; }
+};
+
+#endif // GAME_2048_HINT_H
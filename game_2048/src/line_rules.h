@@ -0,0 +1,131 @@
+#ifndef GAME_2048_LINE_RULES_H
+#define GAME_2048_LINE_RULES_H
+
+#include "types.h"
+
+// The reference movement rules of one line. constexpr, so the packed row
+// tables of board.cc can be checked against them at compile time.
+
+struct TileLineMovement {
+	int from;
+	int to;
+	GameTileType oldTile;
+	GameTileType newTile;
+};
+
+struct FieldLine {
+	GameTileType line[4];
+};
+
+// Each tile makes at most one movement and one merge.
+const int kMaxLineMovements = 8;
+
+struct LineMovements {
+	TileLineMovement movements[kMaxLineMovements];
+	int count;
+};
+
+/*
+	Tile movement logic:
+	 - Check if there is space in line, in direction of movement;
+	 - Check if there are tiles with same number, that are in sequence.
+	If movement is available, then we create movement objects for each
+	available movement.
+	General rules:
+	 - Do all moves in sequence, with processing of every change;
+	 - There is one scenario, in which line has 4 tiles with the same number, and we need to count that;
+	 - Tile merge can occur ONLY with tiles, that were moved by user (for example -> 2 | 2 | 2 | 2 => X | X | 4 | 4 );
+*/
+
+// Move tiles in left direction, IF reversed == true, move in right direction
+constexpr LineMovements moveFieldLine(FieldLine& line, bool reversed) {
+	LineMovements movedTiles{};
+	bool wasTileMerged[4]{false};
+	int i = reversed ? 3 : 0;
+	int stopI = reversed ? 0 : 3;
+	bool endExprI = reversed ? i < stopI : i > stopI;
+	while (!endExprI) {
+		// skip empty tiles
+		if (line.line[i] == GameTileType::NoTile) {
+			i += reversed ? -1 : 1;
+			endExprI = reversed ? i < stopI : i > stopI;
+			continue;
+		}
+		// prepare movements
+		GameTileType upgradeTile = (GameTileType)((int)line.line[i] + 1);
+		TileLineMovement tileMovement{
+			.from = i,
+			.to = -1,
+			.oldTile = line.line[i],
+			.newTile = line.line[i],
+		};
+		TileLineMovement mergedTileMovement{
+			.from = -1,
+			.to = -1,
+			.oldTile = line.line[i],
+			.newTile = upgradeTile,
+		};
+		// check if there is available movement for tile 'i'
+		int lastAvailableSpot = i;
+		int j = reversed ? (i + 1) : (i - 1);
+		int stopJ = reversed ? 3 : 0;
+		bool endExpr = reversed ? j > stopJ : j < stopJ;
+		while (!endExpr) {
+			if (line.line[j] == GameTileType::NoTile) {
+				lastAvailableSpot = j;
+			}
+			else if (line.line[j] == line.line[i] && !wasTileMerged[j]) {
+				lastAvailableSpot = i;
+				break;
+			}
+			else {
+				break;
+			}
+			j += reversed ? 1 : -1;
+			endExpr = reversed ? j > stopJ : j < stopJ;
+		}
+		// if there is available movement - make it
+		if (lastAvailableSpot != i) {
+			tileMovement.to = lastAvailableSpot;
+			line.line[lastAvailableSpot] = line.line[i];
+			line.line[i] = GameTileType::NoTile;
+		}
+		// check if there is available merge for tile 'lastAvailableMovement'
+		int tileToMerge = -1;
+		j = reversed ? (lastAvailableSpot - 1) : (lastAvailableSpot + 1);
+		stopJ = reversed ? 0 : 3;
+		endExpr = reversed ? j < stopJ : j > stopJ;
+		while (!endExpr) {
+			if (line.line[j] == tileMovement.oldTile) {
+				tileToMerge = j;
+				break;
+			}
+			if (line.line[j] != GameTileType::NoTile && line.line[j] != tileMovement.oldTile) {
+				break;
+			}
+			j += reversed ? -1 : 1;
+			endExpr = reversed ? j < stopJ : j > stopJ;
+		}
+		// if merge is available - make it
+		if (tileToMerge != -1) {
+			mergedTileMovement.from = tileToMerge;
+			mergedTileMovement.to = lastAvailableSpot;
+			tileMovement.newTile = mergedTileMovement.newTile;
+			line.line[lastAvailableSpot] = mergedTileMovement.newTile;
+			line.line[tileToMerge] = GameTileType::NoTile;
+			wasTileMerged[lastAvailableSpot] = true;
+		}
+		// if movements were made - add them to the vector
+		if (tileMovement.to != -1) {
+			movedTiles.movements[movedTiles.count++] = tileMovement;
+		}
+		if (mergedTileMovement.to != -1) {
+			movedTiles.movements[movedTiles.count++] = mergedTileMovement;
+		}
+		i += reversed ? -1 : 1;
+		endExprI = reversed ? i < stopI : i > stopI;
+	}
+	return movedTiles;
+}
+
+#endif // GAME_2048_LINE_RULES_H
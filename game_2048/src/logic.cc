@@ -1,6 +1,12 @@
 #include "logic.h"
 
-GameField::GameField() : tiles{}, isInitialized(false), score(0) {
+#include <chrono>
+#include <cmath>
+
+#include "telemetry.h"
+
+GameField::GameField() : tiles{}, isInitialized(false), score(0), moveCount(0),
+	emptyMask(0xFFFF), maxTile(GameTileType::NoTile), hash(0) {
 	std::random_device dev;
 	randomGenerator = std::mt19937(dev());
 }
@@ -11,16 +17,74 @@ int GameField::randomNumber(int min, int max) {
 	return distribution(randomGenerator);
 }
 
+/*
+	The maximum is only raised here: a movement never removes the largest value from the
+	field, it either stays or merges into a larger one, so it is right once the movement
+	is done. Whole field changes call updateTileFeatures() instead.
+*/
+void GameField::setTile(int x, int y, GameTileType tileType) {
+	GameTileType oldTile = tiles[y][x];
+	if (oldTile == tileType) {
+		return;
+	}
+	tiles[y][x] = tileType;
+	hash ^= getZobristKey(x, y, oldTile) ^ getZobristKey(x, y, tileType);
+	std::uint16_t bit = (std::uint16_t)(1 << (4 * y + x));
+	emptyMask = tileType == GameTileType::NoTile ? emptyMask | bit : emptyMask & ~bit;
+	if ((int)tileType > (int)maxTile) {
+		maxTile = tileType;
+	}
+}
+
+void GameField::updateTileFeatures() {
+	emptyMask = 0;
+	maxTile = GameTileType::NoTile;
+	hash = 0;
+	for (int y = 0; y < 4; y++) {
+		for (int x = 0; x < 4; x++) {
+			if (tiles[y][x] == GameTileType::NoTile) {
+				emptyMask |= (std::uint16_t)(1 << (4 * y + x));
+			}
+			if ((int)tiles[y][x] > (int)maxTile) {
+				maxTile = tiles[y][x];
+			}
+			hash ^= getZobristKey(x, y, tiles[y][x]);
+		}
+	}
+}
+
 void GameField::reset() {
     for (int y = 0; y < 4; y++) {
         for (int x = 0; x < 4; x++) {
             tiles[y][x] = GameTileType::NoTile;
         }
     }
+	updateTileFeatures();
 	score = 0;
+	moveCount = 0;
     isInitialized = false;
 }
 
+PackedBoard GameField::getBoard() const {
+	PackedBoard board = 0;
+	for (int y = 0; y < 4; y++) {
+		for (int x = 0; x < 4; x++) {
+			board = setBoardTile(board, x, y, tiles[y][x]);
+		}
+	}
+	return board;
+}
+
+void GameField::setBoard(PackedBoard board) {
+	for (int y = 0; y < 4; y++) {
+		for (int x = 0; x < 4; x++) {
+			tiles[y][x] = getBoardTile(board, x, y);
+		}
+	}
+	updateTileFeatures();
+	isInitialized = board != 0;
+}
+
 std::vector<TileWithPosition> GameField::spawnNewTiles() {
 	std::vector<TileWithPosition> newTiles;
 	auto emptyTiles = getEmptyTiles();
@@ -46,7 +110,8 @@ std::vector<TileWithPosition> GameField::spawnNewTiles() {
 		}
 		int emptyX = emptyTiles[randomIndex].x;
 		int emptyY = emptyTiles[randomIndex].y;
-		tiles[emptyY][emptyX] = tileToSpawn;
+		setTile(emptyX, emptyY, tileToSpawn);
+		recordSpawn(tileToSpawn);
 		newTiles.push_back(TileWithPosition{
 			.x = emptyX,
 			.y = emptyY,
@@ -56,26 +121,33 @@ std::vector<TileWithPosition> GameField::spawnNewTiles() {
 	if (!isInitialized) {
 		isInitialized = true;
 	}
+	// a movement always leaves an empty tile, so only the spawn into the last one can end a game
+	if (emptyMask == 0 && isGameFailed()) {
+		recordGameEnd(moveCount);
+	}
 	return newTiles;
 }
 
 std::vector<TileWithPosition> GameField::getEmptyTiles() {
 	std::vector<TileWithPosition> emptyTiles;
-	for (int y = 0; y < 4; y++) {
-		for (int x = 0; x < 4; x++) {
-			if (tiles[y][x] == GameTileType::NoTile) {
-				emptyTiles.push_back(TileWithPosition{
-					.x = x,
-					.y = y,
-					.tileType = GameTileType::NoTile,
-				});
-			}
-		}
+	emptyTiles.reserve(getEmptyCount());
+	for (std::uint16_t mask = emptyMask; mask != 0; mask &= mask - 1) {
+		int cell = std::countr_zero(mask);
+		emptyTiles.push_back(TileWithPosition{
+			.x = cell % 4,
+			.y = cell / 4,
+			.tileType = GameTileType::NoTile,
+		});
 	}
 	return emptyTiles;
 }
 
 std::vector<TileMovement> GameField::requestMovement(UserMovement movement) {
+	bool isTimed = isMoveLatencySampled();
+	std::chrono::steady_clock::time_point startTime;
+	if (isTimed) {
+		startTime = std::chrono::steady_clock::now();
+	}
 	std::vector<TileMovement> movedTiles;
 	switch (movement) {
 	case UserMovement::Left: {
@@ -114,112 +186,23 @@ std::vector<TileMovement> GameField::requestMovement(UserMovement movement) {
 		if (oldTileValue != 0 && oldTileValue != newTileValue) {
 			int scoreUp = pow(2, newTileValue);
 			score += scoreUp;
+			recordMerge(tile.newTile);
+		}
+	}
+	if (!movedTiles.empty()) {
+		moveCount++;
+		recordMove();
+		if (isTimed) {
+			recordMoveLatency(std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count());
 		}
 	}
 	return movedTiles;
 }
 
-/*
-	Tile movement logic:
-	 - Check if there is space in line, in direction of movement;
-	 - Check if there are tiles with same number, that are in sequence.
-	If movement is available, then we create movement objects for each
-	available movement.
-	General rules:
-	 - Do all moves in sequence, with processing of every change;
-	 - There is one scenario, in which line has 4 tiles with the same number, and we need to count that;
-	 - Tile merge can occur ONLY with tiles, that were moved by user (for example -> 2 | 2 | 2 | 2 => X | X | 4 | 4 );
-*/
-
-// Move tiles in left direction, IF reversed == true, move in right direction
 std::vector<TileLineMovement> GameField::moveLine(FieldLine& line, bool reversed) {
-	std::vector<TileLineMovement> movedTiles;
-	bool wasTileMerged[4]{false};
-	int i = reversed ? 3 : 0;
-	int stopI = reversed ? 0 : 3;
-	bool endExprI = reversed ? i < stopI : i > stopI;
-	while (!endExprI) {
-		// skip empty tiles
-		if (line.line[i] == GameTileType::NoTile) {
-			i += reversed ? -1 : 1;
-			endExprI = reversed ? i < stopI : i > stopI;
-			continue;
-		}
-		// prepare movements
-		GameTileType upgradeTile = (GameTileType)((int)line.line[i] + 1);
-		TileLineMovement tileMovement{
-			.from = i,
-			.to = -1,
-			.oldTile = line.line[i],
-			.newTile = line.line[i],
-		};
-		TileLineMovement mergedTileMovement{
-			.from = -1,
-			.to = -1,
-			.oldTile = line.line[i],
-			.newTile = upgradeTile,
-		};
-		// check if there is available movement for tile 'i'
-		int lastAvailableSpot = i;
-		int j = reversed ? (i + 1) : (i - 1);
-		int stopJ = reversed ? 3 : 0;
-		bool endExpr = reversed ? j > stopJ : j < stopJ;
-		while (!endExpr) {
-			if (line.line[j] == GameTileType::NoTile) {
-				lastAvailableSpot = j;
-			}
-			else if (line.line[j] == line.line[i] && !wasTileMerged[j]) {
-				lastAvailableSpot = i;
-				break;
-			}
-			else {
-				break;
-			}
-			j += reversed ? 1 : -1;
-			endExpr = reversed ? j > stopJ : j < stopJ;
-		}
-		// if there is available movement - make it
-		if (lastAvailableSpot != i) {
-			tileMovement.to = lastAvailableSpot;
-			line.line[lastAvailableSpot] = line.line[i];
-			line.line[i] = GameTileType::NoTile;
-		}
-		// check if there is available merge for tile 'lastAvailableMovement'
-		int tileToMerge = -1;
-		j = reversed ? (lastAvailableSpot - 1) : (lastAvailableSpot + 1);
-		stopJ = reversed ? 0 : 3;
-		endExpr = reversed ? j < stopJ : j > stopJ;
-		while (!endExpr) {
-			if (line.line[j] == tileMovement.oldTile) {
-				tileToMerge = j;
-				break;
-			}
-			if (line.line[j] != GameTileType::NoTile && line.line[j] != tileMovement.oldTile) {
-				break;
-			}
-			j += reversed ? -1 : 1;
-			endExpr = reversed ? j < stopJ : j > stopJ;
-		}
-		// if merge is available - make it
-		if (tileToMerge != -1) {
-			mergedTileMovement.from = tileToMerge;
-			mergedTileMovement.to = lastAvailableSpot;
-			tileMovement.newTile = mergedTileMovement.newTile;
-			line.line[lastAvailableSpot] = mergedTileMovement.newTile;
-			line.line[tileToMerge] = GameTileType::NoTile;
-			wasTileMerged[lastAvailableSpot] = true;
-		}
-		// if movements were made - add them to the vector
-		if (tileMovement.to != -1) {
-			movedTiles.push_back(tileMovement);
-		}
-		if (mergedTileMovement.to != -1) {
-			movedTiles.push_back(mergedTileMovement);
-		}
-		i += reversed ? -1 : 1;
-		endExprI = reversed ? i < stopI : i > stopI;
-	}
-	return movedTiles;
+	LineMovements lineMovements = moveFieldLine(line, reversed);
+	return std::vector<TileLineMovement>(lineMovements.movements, 
+	                                     lineMovements.movements + lineMovements.count);
 }
 
 std::vector<TileMovement> GameField::horizontalMove(bool reversed, bool modifyField) {
@@ -246,10 +229,9 @@ std::vector<TileMovement> GameField::horizontalMove(bool reversed, bool modifyFi
 			});
 		}
 		if (modifyField) {
-			tiles[y][0] = line.line[0];
-			tiles[y][1] = line.line[1];
-			tiles[y][2] = line.line[2];
-			tiles[y][3] = line.line[3];
+			for (int x = 0; x < 4; x++) {
+				setTile(x, y, line.line[x]);
+			}
 		}
 	}
 	return movedTiles;
@@ -279,21 +261,24 @@ std::vector<TileMovement> GameField::verticalMove(bool reversed, bool modifyFiel
 			});
 		}
 		if (modifyField) {
-			tiles[0][x] = line.line[0];
-			tiles[1][x] = line.line[1];
-			tiles[2][x] = line.line[2];
-			tiles[3][x] = line.line[3];
+			for (int y = 0; y < 4; y++) {
+				setTile(x, y, line.line[y]);
+			}
 		}
 	}
 	return movedTiles;
 }
 
 bool GameField::isGameFailed() {
+	// some tile can move toward an empty one, unless the field is empty
+	if (emptyMask != 0 && emptyMask != 0xFFFF) {
+		return false;
+	}
 	bool leftMoveAvailable = horizontalMove(true, false).size() > 0;
 	bool rightMoveAvailable = horizontalMove(false, false).size() > 0;
 	bool upMoveAvailable = verticalMove(true, false).size() > 0;
 	bool downMoveAvailable = verticalMove(false, false).size() > 0;
 	return !leftMoveAvailable && !rightMoveAvailable && 
-           !upMoveAvailable && !downMoveAvailable;
+	       !upMoveAvailable && !downMoveAvailable;
 }
 
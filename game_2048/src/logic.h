@@ -1,10 +1,14 @@
 #ifndef GAME_2048_LOGIC_H
 #define GAME_2048_LOGIC_H
 
+#include <bit>
+#include <cstdint>
 #include <vector>
 #include <random>
 
-#include "window.h"
+#include "types.h"
+#include "line_rules.h"
+#include "board.h"
 
 struct TileMovement {
 	int fromX;
@@ -15,26 +19,25 @@ struct TileMovement {
 	GameTileType newTile;
 };
 
-struct TileLineMovement {
-	int from;
-	int to;
-	GameTileType oldTile;
-	GameTileType newTile;
-};
-
-struct FieldLine {
-	GameTileType line[4];
-};
-
 class GameField {
 private:
 	GameTileType tiles[4][4];
 	bool isInitialized;
 
 	int score;
+	// for telemetry, the length of the game recorded when a spawn ends it
+	int moveCount;
+
+	// Kept up to date by setTile(), so queries don't scan 'tiles'.
+	std::uint16_t emptyMask; // bit 4 * y + x is set for an empty tile
+	GameTileType maxTile;
+	std::uint64_t hash; // getZobristHash(getBoard())
 
 	std::mt19937 randomGenerator;
 
+	void setTile(int x, int y, GameTileType tileType);
+	void updateTileFeatures();
+
 	int randomNumber(int min, int max);
 
 	std::vector<TileWithPosition> getEmptyTiles();
@@ -53,6 +56,13 @@ public:
 	bool isGameInitialized() const { return isInitialized; }
     void reset();
 	int getScore() const { return score; }
+	int getEmptyCount() const { return std::popcount(emptyMask); }
+	std::uint16_t getEmptyMask() const { return emptyMask; }
+	GameTileType getMaxTile() const { return maxTile; }
+	std::uint64_t getHash() const { return hash; }
+	PackedBoard getBoard() const;
+	// Imports a board packed by getBoard(), the score is kept.
+	void setBoard(PackedBoard board);
 };
 
 #endif // GAME_2048_LOGIC_H
@@ -0,0 +1,157 @@
+#include "mapped_file.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : data(nullptr), size(0), isMapped(false) {}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept : 
+	data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)),
+	isMapped(std::exchange(other.isMapped, false)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		close();
+		data = std::exchange(other.data, nullptr);
+		size = std::exchange(other.size, 0);
+		isMapped = std::exchange(other.isMapped, false);
+	}
+	return *this;
+}
+
+#ifdef _WIN32
+
+namespace {
+
+// The mapping keeps its own reference to the file, so both handles are closed right away.
+void* mapFile(HANDLE file, std::size_t size, bool isWritable) {
+	HANDLE mapping = CreateFileMappingA(file, nullptr, isWritable ? PAGE_READWRITE : PAGE_READONLY,
+		(DWORD)((unsigned long long)size >> 32), (DWORD)(size & 0xFFFFFFFF), nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr) {
+		return nullptr;
+	}
+	void* view = MapViewOfFile(mapping, isWritable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+	CloseHandle(mapping);
+	return view;
+}
+
+}
+
+bool MappedFile::openForReading(const std::string& path) {
+	close();
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, 
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+	size = (std::size_t)fileSize.QuadPart;
+	if (size == 0) {
+		CloseHandle(file);
+		isMapped = true;
+		return true;
+	}
+	data = mapFile(file, size, false);
+	isMapped = data != nullptr;
+	return isMapped;
+}
+
+bool MappedFile::createForWriting(const std::string& path, std::size_t newSize) {
+	close();
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, 
+		CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	size = newSize;
+	if (size == 0) {
+		CloseHandle(file);
+		isMapped = true;
+		return true;
+	}
+	data = mapFile(file, size, true);
+	isMapped = data != nullptr;
+	return isMapped;
+}
+
+void MappedFile::close() {
+	if (data != nullptr) {
+		UnmapViewOfFile(data);
+	}
+	data = nullptr;
+	size = 0;
+	isMapped = false;
+}
+
+#else
+
+bool MappedFile::openForReading(const std::string& path) {
+	close();
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0) {
+		::close(file);
+		return false;
+	}
+	size = (std::size_t)fileStat.st_size;
+	if (size > 0) {
+		void* view = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+		data = view != MAP_FAILED ? view : nullptr;
+	}
+	::close(file);
+	isMapped = size == 0 || data != nullptr;
+	return isMapped;
+}
+
+bool MappedFile::createForWriting(const std::string& path, std::size_t newSize) {
+	close();
+	int file = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (file < 0) {
+		return false;
+	}
+	if (ftruncate(file, (off_t)newSize) != 0) {
+		::close(file);
+		return false;
+	}
+	size = newSize;
+	if (size > 0) {
+		void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+		data = view != MAP_FAILED ? view : nullptr;
+	}
+	::close(file);
+	isMapped = size == 0 || data != nullptr;
+	return isMapped;
+}
+
+void MappedFile::close() {
+	if (data != nullptr) {
+		munmap(data, size);
+	}
+	data = nullptr;
+	size = 0;
+	isMapped = false;
+}
+
+#endif
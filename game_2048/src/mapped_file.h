@@ -0,0 +1,35 @@
+#ifndef GAME_2048_MAPPED_FILE_H
+#define GAME_2048_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Whole file mapped into memory. Pages are loaded by the OS on first access
+// and can be dropped under memory pressure, so tables larger than RAM work.
+class MappedFile {
+private:
+	void* data;
+	std::size_t size;
+	bool isMapped;
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	bool openForReading(const std::string& path);
+	// Creates (or truncates) the file with the given size, mapped for writing.
+	bool createForWriting(const std::string& path, std::size_t newSize);
+	void close();
+
+	bool isOpen() const { return isMapped; }
+	const void* getData() const { return data; }
+	void* getWritableData() { return data; }
+	std::size_t getSize() const { return size; }
+};
+
+#endif // GAME_2048_MAPPED_FILE_H
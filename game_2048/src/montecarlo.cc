@@ -0,0 +1,161 @@
+#include "montecarlo.h"
+
+#if defined(GAME_2048_AVX2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef GAME_2048_AVX2
+void moveBoardsAvx2(const PackedBoard* boards, const UserMovement* movements, 
+                    PackedBoard* movedBoards, int* scores, int count);
+#endif
+
+bool isSimdRolloutAvailable() {
+#if defined(GAME_2048_AVX2) && defined(_MSC_VER)
+	static const bool isAvailable = [] {
+		int info[4];
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+	}();
+	return isAvailable;
+#elif defined(GAME_2048_AVX2)
+	static const bool isAvailable = __builtin_cpu_supports("avx2");
+	return isAvailable;
+#else
+	return false;
+#endif
+}
+
+void moveBoards(const PackedBoard* boards, const UserMovement* movements, 
+                PackedBoard* movedBoards, int* scores, int count) {
+#ifdef GAME_2048_AVX2
+	if (isSimdRolloutAvailable()) {
+		moveBoardsAvx2(boards, movements, movedBoards, scores, count);
+		return;
+	}
+#endif
+	for (int i = 0; i < count; i++) {
+		movedBoards[i] = moveBoard(boards[i], movements[i], scores != nullptr ? scores + i : nullptr);
+	}
+}
+
+MonteCarloPolicy::MonteCarloPolicy(int rolloutsPerMove, std::uint64_t seed) : 
+	rolloutsPerMove(rolloutsPerMove), random(seed) {}
+
+/*
+	Rollouts are played in lanes of kRolloutBatchSize boards, so all boards
+	do one move per moveBoards() call. A lane that finished its game takes the
+	next rollout of the queue, lanes only stay idle at the very end.
+	Every step tries a random movement, and if it does not change the board,
+	the following movements in order, until no movement is left.
+*/
+SearchResult MonteCarloPolicy::findBestMove(PackedBoard board) {
+	SearchResult result{
+		.bestMovement = UserMovement::None,
+		.value = 0,
+		.nodeCount = 0,
+		.depth = 0,
+		.isAborted = false,
+	};
+	PackedBoard rootBoards[4];
+	int rootScores[4] = {};
+	int rootMovements[4];
+	int rootCount = 0;
+	for (int i = 0; i < 4; i++) {
+		int score = 0;
+		PackedBoard movedBoard = moveBoard(board, (UserMovement)(i + 1), &score);
+		if (movedBoard != board) {
+			rootBoards[rootCount] = movedBoard;
+			rootScores[rootCount] = score;
+			rootMovements[rootCount] = i;
+			rootCount++;
+		}
+	}
+	if (rootCount == 0) {
+		return result;
+	}
+	double totalScores[4] = {};
+	int nextRollout = 0;
+	int rolloutCount = rolloutsPerMove * rootCount;
+	Rollout lanes[kRolloutBatchSize];
+	auto startRollout = [&](Rollout& lane) {
+		if (nextRollout == rolloutCount) {
+			lane.isActive = false;
+			return;
+		}
+		int root = nextRollout % rootCount;
+		nextRollout++;
+		lane = Rollout{
+			.board = spawnRandomTile(rootBoards[root], random.next()),
+			.score = rootScores[root],
+			.moves = 0,
+			.rootMovement = root,
+			.isActive = true,
+		};
+	};
+	for (auto& lane : lanes) {
+		startRollout(lane);
+	}
+
+	PackedBoard boards[kRolloutBatchSize];
+	PackedBoard movedBoards[kRolloutBatchSize];
+	UserMovement movements[kRolloutBatchSize];
+	int scores[kRolloutBatchSize];
+	bool isMoved[kRolloutBatchSize];
+	int activeCount = kRolloutBatchSize;
+	while (activeCount > 0) {
+		if (shouldStop && shouldStop()) {
+			result.isAborted = true;
+			return result;
+		}
+		for (int i = 0; i < kRolloutBatchSize; i++) {
+			boards[i] = lanes[i].board;
+			movements[i] = (UserMovement)(1 + random.next() % 4);
+			scores[i] = 0;
+			isMoved[i] = !lanes[i].isActive;
+		}
+		for (int attempt = 0; attempt < 4; attempt++) {
+			moveBoards(boards, movements, movedBoards, scores, kRolloutBatchSize);
+			bool isAllMoved = true;
+			for (int i = 0; i < kRolloutBatchSize; i++) {
+				if (isMoved[i]) {
+					continue;
+				}
+				if (movedBoards[i] != boards[i]) {
+					isMoved[i] = true;
+					lanes[i].board = spawnRandomTile(movedBoards[i], random.next());
+					lanes[i].score += scores[i];
+					lanes[i].moves++;
+					continue;
+				}
+				scores[i] = 0;
+				movements[i] = (UserMovement)(1 + ((int)movements[i] % 4));
+				isAllMoved = false;
+			}
+			result.nodeCount += kRolloutBatchSize;
+			if (isAllMoved) {
+				break;
+			}
+		}
+		activeCount = 0;
+		for (int i = 0; i < kRolloutBatchSize; i++) {
+			if (!lanes[i].isActive) {
+				continue;
+			}
+			if (!isMoved[i] || lanes[i].moves == kMaxRolloutMoves) {
+				totalScores[lanes[i].rootMovement] += lanes[i].score;
+				startRollout(lanes[i]);
+			}
+			if (lanes[i].isActive) {
+				activeCount++;
+			}
+		}
+	}
+	for (int root = 0; root < rootCount; root++) {
+		float averageScore = (float)(totalScores[root] / rolloutsPerMove);
+		if (result.bestMovement == UserMovement::None || averageScore > result.value) {
+			result.bestMovement = (UserMovement)(rootMovements[root] + 1);
+			result.value = averageScore;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,46 @@
+#ifndef GAME_2048_MONTECARLO_H
+#define GAME_2048_MONTECARLO_H
+
+#include <cstdint>
+#include <functional>
+
+#include "board.h"
+#include "search.h"
+
+// Boards that are stepped together by one call of moveBoards() in rollouts.
+const int kRolloutBatchSize = 8;
+const int kDefaultRolloutsPerMove = 256;
+// Rollouts that survive this many moves are cut off.
+const int kMaxRolloutMoves = 1000;
+
+// Apply a separate movement to each board, same as moveBoard() for each
+// of them. Uses AVX2 when both the build and the CPU support it.
+void moveBoards(const PackedBoard* boards, const UserMovement* movements, 
+                PackedBoard* movedBoards, int* scores, int count);
+bool isSimdRolloutAvailable();
+
+// Evaluates every root movement by the average score of random games played after it.
+class MonteCarloPolicy {
+private:
+	struct Rollout {
+		PackedBoard board;
+		int score;
+		int moves;
+		int rootMovement;
+		bool isActive;
+	};
+
+	int rolloutsPerMove;
+	FastRandom random;
+	std::function<bool()> shouldStop;
+
+public:
+	MonteCarloPolicy(int rolloutsPerMove = kDefaultRolloutsPerMove, std::uint64_t seed = 0x2048);
+
+	void setStopCondition(std::function<bool()> condition) { shouldStop = condition; }
+
+	// SearchResult::value is the average rollout score, nodeCount - simulated moves.
+	SearchResult findBestMove(PackedBoard board);
+};
+
+#endif // GAME_2048_MONTECARLO_H
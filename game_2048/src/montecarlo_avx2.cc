@@ -0,0 +1,105 @@
+// Compiled with AVX2 code generation, must be called only after the runtime CPU check.
+#ifdef GAME_2048_AVX2
+
+#include "board.h"
+#include "row_tables.h"
+
+#include <immintrin.h>
+
+namespace {
+
+// Left and right moves of all rows: [0; 65536) - left, [65536; 131072) - right.
+// Every entry is the moved row in low 16 bits and (score / 4) in high 16 bits.
+struct PackedRowTable {
+	std::uint32_t entries[2 * kRowCount];
+};
+
+constexpr PackedRowTable buildPackedRowTable() {
+	PackedRowTable table{};
+	for (int row = 0; row < kRowCount; row++) {
+		int score = 0;
+		PackedRow reversed = reverseRow((PackedRow)row);
+		PackedRow left = moveRowLeft((PackedRow)row, score);
+		table.entries[row] = (std::uint32_t)left | ((std::uint32_t)(score / 4) << 16);
+		table.entries[kRowCount + reversed] = (std::uint32_t)reverseRow(left) | ((std::uint32_t)(score / 4) << 16);
+	}
+	return table;
+}
+
+constexpr PackedRowTable kPackedRowTable = buildPackedRowTable();
+
+const std::uint32_t* getPackedRowTable() {
+	return kPackedRowTable.entries;
+}
+
+__m256i transposeBoards(__m256i boards) {
+	__m256i a1 = _mm256_and_si256(boards, _mm256_set1_epi64x((long long)0xF0F00F0FF0F00F0FULL));
+	__m256i a2 = _mm256_and_si256(boards, _mm256_set1_epi64x((long long)0x0000F0F00000F0F0ULL));
+	__m256i a3 = _mm256_and_si256(boards, _mm256_set1_epi64x((long long)0x0F0F00000F0F0000ULL));
+	__m256i a = _mm256_or_si256(a1, _mm256_or_si256(_mm256_slli_epi64(a2, 12), _mm256_srli_epi64(a3, 12)));
+	__m256i b1 = _mm256_and_si256(a, _mm256_set1_epi64x((long long)0xFF00FF0000FF00FFULL));
+	__m256i b2 = _mm256_and_si256(a, _mm256_set1_epi64x((long long)0x00FF00FF00000000ULL));
+	__m256i b3 = _mm256_and_si256(a, _mm256_set1_epi64x((long long)0x00000000FF00FF00ULL));
+	return _mm256_or_si256(b1, _mm256_or_si256(_mm256_srli_epi64(b2, 24), _mm256_slli_epi64(b3, 24)));
+}
+
+// Four boards per call: vertical movements are turned into horizontal ones by
+// transposing, right movements read the second half of the row table.
+void moveFourBoards(const PackedBoard* boards, const UserMovement* movements, 
+                    PackedBoard* movedBoards, int* scores, const std::uint32_t* table) {
+	long long verticalMask[4];
+	int rightOffset[4];
+	for (int i = 0; i < 4; i++) {
+		bool isVertical = movements[i] == UserMovement::Up || movements[i] == UserMovement::Down;
+		bool isRight = movements[i] == UserMovement::Right || movements[i] == UserMovement::Down;
+		verticalMask[i] = isVertical ? -1 : 0;
+		rightOffset[i] = isRight ? kRowCount : 0;
+	}
+	__m256i vertical = _mm256_loadu_si256((const __m256i*)verticalMask);
+	__m256i input = _mm256_loadu_si256((const __m256i*)boards);
+	input = _mm256_blendv_epi8(input, transposeBoards(input), vertical);
+
+	__m256i offsetsLow = _mm256_setr_epi32(rightOffset[0], rightOffset[0], rightOffset[0], rightOffset[0],
+	                                       rightOffset[1], rightOffset[1], rightOffset[1], rightOffset[1]);
+	__m256i offsetsHigh = _mm256_setr_epi32(rightOffset[2], rightOffset[2], rightOffset[2], rightOffset[2],
+	                                        rightOffset[3], rightOffset[3], rightOffset[3], rightOffset[3]);
+	__m256i rowsLow = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(input));
+	__m256i rowsHigh = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(input, 1));
+	__m256i resultLow = _mm256_i32gather_epi32((const int*)table, _mm256_add_epi32(rowsLow, offsetsLow), 4);
+	__m256i resultHigh = _mm256_i32gather_epi32((const int*)table, _mm256_add_epi32(rowsHigh, offsetsHigh), 4);
+
+	__m256i rowMask = _mm256_set1_epi32(0xFFFF);
+	// packus works inside 128-bit halves: [b0, b2 | b1, b3], put the boards back in order
+	__m256i output = _mm256_packus_epi32(_mm256_and_si256(resultLow, rowMask),
+	                                     _mm256_and_si256(resultHigh, rowMask));
+	output = _mm256_permute4x64_epi64(output, 0xD8);
+	output = _mm256_blendv_epi8(output, transposeBoards(output), vertical);
+	_mm256_storeu_si256((__m256i*)movedBoards, output);
+
+	if (scores != nullptr) {
+		alignas(32) std::uint32_t rowScores[16];
+		_mm256_store_si256((__m256i*)rowScores, _mm256_srli_epi32(resultLow, 16));
+		_mm256_store_si256((__m256i*)(rowScores + 8), _mm256_srli_epi32(resultHigh, 16));
+		for (int i = 0; i < 4; i++) {
+			scores[i] += 4 * (int)(rowScores[4 * i] + rowScores[4 * i + 1] + 
+			                       rowScores[4 * i + 2] + rowScores[4 * i + 3]);
+		}
+	}
+}
+
+}
+
+void moveBoardsAvx2(const PackedBoard* boards, const UserMovement* movements, 
+                    PackedBoard* movedBoards, int* scores, int count) {
+	const std::uint32_t* table = getPackedRowTable();
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		moveFourBoards(boards + i, movements + i, movedBoards + i, 
+		               scores != nullptr ? scores + i : nullptr, table);
+	}
+	for (; i < count; i++) {
+		movedBoards[i] = moveBoard(boards[i], movements[i], scores != nullptr ? scores + i : nullptr);
+	}
+}
+
+#endif // GAME_2048_AVX2
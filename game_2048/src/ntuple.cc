@@ -0,0 +1,272 @@
+#include "ntuple.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include "symmetry.h"
+
+/*
+	Weights file layout (little-endian):
+	 - "2048NTUP", u32 version, u32 tuple count, u32 1 if weights are int16;
+	 - for every tuple: u32 cell count, u32 cells[], f32 scale, then the weights
+	   as blocks of (u32 zero count, u32 value count, values[]) until the
+	   table is full. Most of a trained table was never visited and stays zero,
+	   so the blocks keep the file at a fraction of the table size.
+*/
+const char kWeightsFileMagic[8] = { '2', '0', '4', '8', 'N', 'T', 'U', 'P' };
+const std::uint32_t kWeightsFileVersion = 1;
+
+namespace {
+
+template <typename T>
+void writeValue(std::ofstream& file, const T& value) {
+	file.write((const char*)&value, sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::ifstream& file, T& value) {
+	return (bool)file.read((char*)&value, sizeof(T));
+}
+
+template <typename T>
+void writeWeights(std::ofstream& file, const std::vector<T>& weights) {
+	std::size_t i = 0;
+	while (i < weights.size()) {
+		std::size_t zeroStart = i;
+		while (i < weights.size() && weights[i] == 0) {
+			i++;
+		}
+		std::size_t valueStart = i;
+		while (i < weights.size() && weights[i] != 0) {
+			i++;
+		}
+		writeValue(file, (std::uint32_t)(valueStart - zeroStart));
+		writeValue(file, (std::uint32_t)(i - valueStart));
+		file.write((const char*)(weights.data() + valueStart), (i - valueStart) * sizeof(T));
+	}
+}
+
+template <typename T>
+bool readWeights(std::ifstream& file, std::vector<T>& weights) {
+	std::size_t i = 0;
+	while (i < weights.size()) {
+		std::uint32_t zeroCount = 0;
+		std::uint32_t valueCount = 0;
+		if (!readValue(file, zeroCount) || !readValue(file, valueCount) ||
+		    i + zeroCount + valueCount > weights.size()) {
+			return false;
+		}
+		std::fill(weights.begin() + i, weights.begin() + i + zeroCount, (T)0);
+		i += zeroCount;
+		if (!file.read((char*)(weights.data() + i), valueCount * sizeof(T))) {
+			return false;
+		}
+		i += valueCount;
+	}
+	return true;
+}
+
+}
+
+NTupleNetwork::NTupleNetwork() : isQuantized(false) {}
+
+NTupleNetwork NTupleNetwork::createDefault() {
+	NTupleNetwork network;
+	network.addTuple({ 0, 1, 2, 3, 4, 5 });
+	network.addTuple({ 4, 5, 6, 7, 8, 9 });
+	network.addTuple({ 0, 1, 2, 4, 5, 6 });
+	network.addTuple({ 4, 5, 6, 8, 9, 10 });
+	return network;
+}
+
+void NTupleNetwork::addTuple(const std::vector<int>& cells) {
+	Tuple tuple{
+		.cells = cells,
+		.weights = std::vector<float>((std::size_t)1 << (4 * cells.size()), 0.0f),
+		.quantizedWeights = {},
+		.scale = 1.0f,
+	};
+	tuples.push_back(std::move(tuple));
+	isQuantized = false;
+}
+
+std::size_t NTupleNetwork::getIndex(const Tuple& tuple, PackedBoard board) {
+	std::size_t index = 0;
+	for (std::size_t i = 0; i < tuple.cells.size(); i++) {
+		index |= (std::size_t)((board >> (4 * tuple.cells[i])) & 0xF) << (4 * i);
+	}
+	return index;
+}
+
+float NTupleNetwork::evaluate(PackedBoard board) const {
+	PackedBoard boards[8];
+	getSymmetricBoards(board, boards);
+	float value = 0;
+	for (const auto& tuple : tuples) {
+		if (isQuantized) {
+			int sum = 0;
+			for (int i = 0; i < 8; i++) {
+				sum += tuple.quantizedWeights[getIndex(tuple, boards[i])];
+			}
+			value += sum * tuple.scale;
+		}
+		else {
+			for (int i = 0; i < 8; i++) {
+				value += tuple.weights[getIndex(tuple, boards[i])];
+			}
+		}
+	}
+	return value;
+}
+
+void NTupleNetwork::update(PackedBoard board, float delta) {
+	if (isQuantized) {
+		return;
+	}
+	PackedBoard boards[8];
+	getSymmetricBoards(board, boards);
+	for (auto& tuple : tuples) {
+		for (int i = 0; i < 8; i++) {
+			tuple.weights[getIndex(tuple, boards[i])] += delta;
+		}
+	}
+}
+
+void NTupleNetwork::quantize() {
+	if (isQuantized) {
+		return;
+	}
+	for (auto& tuple : tuples) {
+		float maxWeight = 0;
+		for (float weight : tuple.weights) {
+			maxWeight = std::fmax(maxWeight, std::fabs(weight));
+		}
+		tuple.scale = maxWeight > 0 ? maxWeight / 32767.0f : 1.0f;
+		tuple.quantizedWeights.resize(tuple.weights.size());
+		for (std::size_t i = 0; i < tuple.weights.size(); i++) {
+			tuple.quantizedWeights[i] = (std::int16_t)std::lround(tuple.weights[i] / tuple.scale);
+		}
+		tuple.weights = std::vector<float>();
+	}
+	isQuantized = true;
+}
+
+bool NTupleNetwork::save(const std::string& path) const {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	file.write(kWeightsFileMagic, sizeof(kWeightsFileMagic));
+	writeValue(file, kWeightsFileVersion);
+	writeValue(file, (std::uint32_t)tuples.size());
+	writeValue(file, (std::uint32_t)(isQuantized ? 1 : 0));
+	for (const auto& tuple : tuples) {
+		writeValue(file, (std::uint32_t)tuple.cells.size());
+		for (int cell : tuple.cells) {
+			writeValue(file, (std::uint32_t)cell);
+		}
+		writeValue(file, tuple.scale);
+		if (isQuantized) {
+			writeWeights(file, tuple.quantizedWeights);
+		}
+		else {
+			writeWeights(file, tuple.weights);
+		}
+	}
+	return (bool)file;
+}
+
+bool NTupleNetwork::load(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	char magic[sizeof(kWeightsFileMagic)];
+	std::uint32_t version = 0;
+	std::uint32_t tupleCount = 0;
+	std::uint32_t quantized = 0;
+	if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, kWeightsFileMagic, sizeof(magic)) != 0 ||
+	    !readValue(file, version) || version != kWeightsFileVersion ||
+	    !readValue(file, tupleCount) || !readValue(file, quantized)) {
+		return false;
+	}
+	std::vector<Tuple> newTuples;
+	for (std::uint32_t t = 0; t < tupleCount; t++) {
+		std::uint32_t cellCount = 0;
+		if (!readValue(file, cellCount) || cellCount == 0 || cellCount > 8) {
+			return false;
+		}
+		Tuple tuple{ .cells = {}, .weights = {}, .quantizedWeights = {}, .scale = 1.0f };
+		for (std::uint32_t i = 0; i < cellCount; i++) {
+			std::uint32_t cell = 0;
+			if (!readValue(file, cell) || cell > 15) {
+				return false;
+			}
+			tuple.cells.push_back((int)cell);
+		}
+		if (!readValue(file, tuple.scale)) {
+			return false;
+		}
+		std::size_t weightCount = (std::size_t)1 << (4 * cellCount);
+		bool isRead = false;
+		if (quantized != 0) {
+			tuple.quantizedWeights.resize(weightCount);
+			isRead = readWeights(file, tuple.quantizedWeights);
+		}
+		else {
+			tuple.weights.resize(weightCount);
+			isRead = readWeights(file, tuple.weights);
+		}
+		if (!isRead) {
+			return false;
+		}
+		newTuples.push_back(std::move(tuple));
+	}
+	tuples = std::move(newTuples);
+	isQuantized = quantized != 0;
+	return true;
+}
+
+TrainingGameResult playTrainingGame(NTupleNetwork& network, FastRandom& random, float learningRate) {
+	float featureRate = learningRate / network.getFeatureCount();
+	PackedBoard board = spawnRandomTile(spawnRandomTile(0, random.next()), random.next());
+	PackedBoard previousAfterstate = 0;
+	bool hasPreviousAfterstate = false;
+	TrainingGameResult result{ .score = 0, .moves = 0, .maxTile = GameTileType::NoTile };
+	while (true) {
+		PackedBoard bestAfterstate = board;
+		float bestValue = 0;
+		int bestScore = 0;
+		for (int i = (int)UserMovement::Left; i <= (int)UserMovement::Down; i++) {
+			int score = 0;
+			PackedBoard afterstate = moveBoard(board, (UserMovement)i, &score);
+			if (afterstate == board) {
+				continue;
+			}
+			float value = score + network.evaluate(afterstate);
+			if (bestAfterstate == board || value > bestValue) {
+				bestAfterstate = afterstate;
+				bestValue = value;
+				bestScore = score;
+			}
+		}
+		if (bestAfterstate == board) {
+			break;
+		}
+		if (hasPreviousAfterstate) {
+			network.update(previousAfterstate, 
+				featureRate * (bestValue - network.evaluate(previousAfterstate)));
+		}
+		previousAfterstate = bestAfterstate;
+		hasPreviousAfterstate = true;
+		result.score += bestScore;
+		result.moves++;
+		board = spawnRandomTile(bestAfterstate, random.next());
+	}
+	if (hasPreviousAfterstate) {
+		network.update(previousAfterstate, -featureRate * network.evaluate(previousAfterstate));
+	}
+	result.maxTile = getMaxTile(board);
+	return result;
+}
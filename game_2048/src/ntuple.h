@@ -0,0 +1,70 @@
+#ifndef GAME_2048_NTUPLE_H
+#define GAME_2048_NTUPLE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "search.h"
+
+// Weights file that the game loads at startup, if it exists.
+const std::string kNTupleWeightsFile = "ntuple_weights.bin";
+
+/*
+	N-tuple network: the value of a board is the sum of weights looked up by
+	the tiles under every tuple, for all 8 symmetries of the board.
+	Every tuple owns one contiguous table of 16^n weights. The evaluation
+	goes tuple by tuple, so all 8 lookups of a tuple hit the same table.
+	Weights are float while training, quantize() turns them into int16 with
+	a per-tuple scale, halving the memory that search has to touch.
+*/
+class NTupleNetwork : public IBoardEvaluator {
+private:
+	struct Tuple {
+		std::vector<int> cells; // tile indices, 4 * y + x
+		std::vector<float> weights;
+		std::vector<std::int16_t> quantizedWeights;
+		float scale;
+	};
+
+	std::vector<Tuple> tuples;
+	bool isQuantized;
+
+	static std::size_t getIndex(const Tuple& tuple, PackedBoard board);
+
+public:
+	NTupleNetwork();
+
+	// 4 x 6-tuples from Jaskowski's "Mastering 2048 with delayed temporal
+	// coherence learning" (~256 MB of float weights).
+	static NTupleNetwork createDefault();
+
+	void addTuple(const std::vector<int>& cells);
+
+	virtual float evaluate(PackedBoard board) const;
+	// Trained by TD(0) on afterstates, see playTrainingGame().
+	virtual bool isAfterstateValue() const { return true; }
+	// Add 'delta' to every weight that contributes to the board. Float weights only.
+	void update(PackedBoard board, float delta);
+	int getFeatureCount() const { return (int)tuples.size() * 8; }
+
+	void quantize();
+	bool getIsQuantized() const { return isQuantized; }
+
+	bool save(const std::string& path) const;
+	bool load(const std::string& path);
+};
+
+struct TrainingGameResult {
+	int score;
+	int moves;
+	GameTileType maxTile;
+};
+
+// Play one game greedily by the network and learn from it with TD(0) on
+// afterstates (the board after a movement, before the spawn).
+// 'learningRate' is shared between all the features of a board.
+TrainingGameResult playTrainingGame(NTupleNetwork& network, FastRandom& random, float learningRate);
+
+#endif // GAME_2048_NTUPLE_H
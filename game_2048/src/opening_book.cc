@@ -0,0 +1,185 @@
+#include "opening_book.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "symmetry.h"
+
+/*
+	Book file layout (little-endian):
+	 - "2048BOOK", u32 version, u32 search depth, u64 entry count, u64 reserved;
+	 - entries sorted by board, 16 bytes each: u64 board, f32 value, u8 movement, u8 depth, u16 reserved.
+*/
+const char kOpeningBookMagic[8] = { '2', '0', '4', '8', 'B', 'O', 'O', 'K' };
+const std::uint32_t kOpeningBookVersion = 1;
+
+namespace {
+
+struct OpeningBookHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t searchDepth;
+	std::uint64_t entryCount;
+	std::uint64_t reserved;
+};
+
+static_assert(sizeof(OpeningBookHeader) == 32, "Opening book header must be 32 bytes");
+
+void sortUnique(std::vector<PackedBoard>& boards) {
+	std::sort(boards.begin(), boards.end());
+	boards.erase(std::unique(boards.begin(), boards.end()), boards.end());
+}
+
+// Canonical boards of every start that GameField::spawnNewTiles() can produce.
+std::vector<PackedBoard> getStartBoards() {
+	std::vector<PackedBoard> boards;
+	for (int first = 0; first < 16; first++) {
+		for (int second = first + 1; second < 16; second++) {
+			for (int tiles = 0; tiles < 4; tiles++) {
+				PackedBoard board = ((PackedBoard)(1 + (tiles & 1)) << (4 * first)) |
+				                    ((PackedBoard)(1 + (tiles >> 1)) << (4 * second));
+				boards.push_back(canonicalizeBoard(board).board);
+			}
+		}
+	}
+	sortUnique(boards);
+	return boards;
+}
+
+void searchBoards(const std::vector<PackedBoard>& boards, const OpeningBookOptions& options,
+                  std::vector<OpeningBookEntry>& entries) {
+	std::size_t firstEntry = entries.size();
+	entries.resize(firstEntry + boards.size());
+	std::atomic<std::size_t> nextBoard(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < std::max(1, options.threadCount); t++) {
+		threads.emplace_back([&] {
+			ExpectimaxSearch search;
+			search.setEvaluator(options.evaluator);
+			for (std::size_t i = nextBoard.fetch_add(1); i < boards.size(); i = nextBoard.fetch_add(1)) {
+				SearchResult result = search.findBestMove(boards[i], options.searchDepth);
+				entries[firstEntry + i] = OpeningBookEntry{
+					.board = boards[i],
+					.value = result.value,
+					.movement = (std::uint8_t)result.bestMovement,
+					.depth = (std::uint8_t)options.searchDepth,
+					.reserved = 0,
+				};
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+}
+
+bool buildOpeningBook(const OpeningBookOptions& options, std::size_t* entryCount) {
+	std::vector<OpeningBookEntry> entries;
+	std::vector<PackedBoard> knownBoards;
+	std::vector<PackedBoard> plyBoards = getStartBoards();
+	for (int ply = 0; !plyBoards.empty(); ply++) {
+		std::size_t firstEntry = entries.size();
+		searchBoards(plyBoards, options, entries);
+		knownBoards.insert(knownBoards.end(), plyBoards.begin(), plyBoards.end());
+		sortUnique(knownBoards);
+		if (ply == options.maxPly) {
+			break;
+		}
+		// every spawn after the book's move, positions of earlier plies are already in the book
+		std::vector<PackedBoard> nextBoards;
+		for (std::size_t i = firstEntry; i < entries.size(); i++) {
+			UserMovement movement = (UserMovement)entries[i].movement;
+			if (movement == UserMovement::None) {
+				continue;
+			}
+			PackedBoard movedBoard = moveBoard(entries[i].board, movement);
+			for (int cell = 0; cell < 16; cell++) {
+				if (getBoardTile(movedBoard, cell % 4, cell / 4) != GameTileType::NoTile) {
+					continue;
+				}
+				for (PackedBoard tile = 1; tile <= 2; tile++) {
+					PackedBoard board = canonicalizeBoard(movedBoard | (tile << (4 * cell))).board;
+					if (!std::binary_search(knownBoards.begin(), knownBoards.end(), board)) {
+						nextBoards.push_back(board);
+					}
+				}
+			}
+		}
+		sortUnique(nextBoards);
+		if (entries.size() + nextBoards.size() > options.maxPositions) {
+			break;
+		}
+		plyBoards = std::move(nextBoards);
+	}
+	std::sort(entries.begin(), entries.end(), [](const OpeningBookEntry& a, const OpeningBookEntry& b) {
+		return a.board < b.board;
+	});
+
+	std::ofstream file(options.path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+	OpeningBookHeader header{
+		.magic = {},
+		.version = kOpeningBookVersion,
+		.searchDepth = (std::uint32_t)options.searchDepth,
+		.entryCount = entries.size(),
+		.reserved = 0,
+	};
+	std::memcpy(header.magic, kOpeningBookMagic, sizeof(kOpeningBookMagic));
+	file.write((const char*)&header, sizeof(header));
+	file.write((const char*)entries.data(), entries.size() * sizeof(OpeningBookEntry));
+	if (entryCount != nullptr) {
+		*entryCount = entries.size();
+	}
+	return (bool)file;
+}
+
+OpeningBook::OpeningBook() : entries(nullptr), entryCount(0) {}
+
+bool OpeningBook::open(const std::string& path) {
+	entries = nullptr;
+	entryCount = 0;
+	if (!file.openForReading(path) || file.getSize() < sizeof(OpeningBookHeader)) {
+		file.close();
+		return false;
+	}
+	const OpeningBookHeader* header = (const OpeningBookHeader*)file.getData();
+	if (std::memcmp(header->magic, kOpeningBookMagic, sizeof(kOpeningBookMagic)) != 0 ||
+	    header->version != kOpeningBookVersion ||
+	    file.getSize() != sizeof(OpeningBookHeader) + header->entryCount * sizeof(OpeningBookEntry)) {
+		file.close();
+		return false;
+	}
+	entries = (const OpeningBookEntry*)(header + 1);
+	entryCount = header->entryCount;
+	return true;
+}
+
+bool OpeningBook::lookup(PackedBoard board, UserMovement& movement, float& value) const {
+	if (entryCount == 0) {
+		return false;
+	}
+	CanonicalBoard canonical = canonicalizeBoard(board);
+	// branchless binary search, the halving steps do not depend on the comparisons
+	const OpeningBookEntry* first = entries;
+	std::size_t length = entryCount;
+	while (length > 1) {
+		std::size_t half = length / 2;
+		first = first[half].board < canonical.board ? first + half : first;
+		length -= half;
+	}
+	first += first->board < canonical.board ? 1 : 0;
+	if (first == entries + entryCount || first->board != canonical.board) {
+		return false;
+	}
+	movement = untransformMovement((UserMovement)first->movement, canonical.transform);
+	value = first->value;
+	return movement != UserMovement::None;
+}
@@ -0,0 +1,61 @@
+#ifndef GAME_2048_OPENING_BOOK_H
+#define GAME_2048_OPENING_BOOK_H
+
+#include <cstdint>
+#include <string>
+
+#include "board.h"
+#include "mapped_file.h"
+#include "search.h"
+
+// Book that the game loads at startup, if it exists.
+const std::string kOpeningBookFile = "opening_book.bin";
+
+// One book record, the board is canonical and the movement is for that canonical board.
+struct OpeningBookEntry {
+	PackedBoard board;
+	float value;
+	std::uint8_t movement;
+	std::uint8_t depth;
+	std::uint16_t reserved;
+};
+
+static_assert(sizeof(OpeningBookEntry) == 16, "Opening book records must be 16 bytes");
+
+struct OpeningBookOptions {
+	int searchDepth;
+	// Plies of the book's own moves to cover, every spawn after them is expanded.
+	int maxPly;
+	// Expansion stops before a ply that would exceed it.
+	std::size_t maxPositions;
+	int threadCount;
+	const IBoardEvaluator* evaluator; // nullptr - evaluateBoard()
+	std::string path;
+};
+
+/*
+	The book covers every position reachable from all two-tile starts when the book's
+	own moves are played, ply by ply, until the position budget is used up. Positions
+	are searched deeply once, offline, and written sorted by board, so the game only
+	needs a binary search over the mapped file instead of a search.
+*/
+bool buildOpeningBook(const OpeningBookOptions& options, std::size_t* entryCount = nullptr);
+
+class OpeningBook {
+private:
+	MappedFile file;
+	const OpeningBookEntry* entries;
+	std::size_t entryCount;
+
+public:
+	OpeningBook();
+
+	bool open(const std::string& path);
+	bool isOpen() const { return entries != nullptr; }
+	std::size_t getEntryCount() const { return entryCount; }
+
+	// Best movement for 'board' itself (not the canonical one), false if the board is not in the book.
+	bool lookup(PackedBoard board, UserMovement& movement, float& value) const;
+};
+
+#endif // GAME_2048_OPENING_BOOK_H
@@ -0,0 +1,130 @@
+#include "perft.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include "logic.h"
+#include "symmetry.h"
+
+namespace {
+
+using PerftCounts = std::unordered_map<PackedBoard, std::uint64_t>;
+
+struct PerftShard {
+	// partitions of the next ply, by hashBoard() % thread count
+	std::vector<PerftCounts> partitions;
+	std::uint64_t generatedCount = 0;
+	std::uint64_t scoreSum = 0;
+};
+
+// Board after the movement by the chosen engine, the same board if nothing moved.
+PackedBoard applyMovement(PerftEngine engine, GameField& field, PackedBoard board, UserMovement movement, int& score) {
+	score = 0;
+	if (engine == PerftEngine::Table) {
+		return moveBoard(board, movement, &score);
+	}
+	field.setBoard(board);
+	int oldScore = field.getScore();
+	if (field.requestMovement(movement).empty()) {
+		return board;
+	}
+	score = field.getScore() - oldScore;
+	return field.getBoard();
+}
+
+void expandBoards(const std::vector<std::pair<PackedBoard, std::uint64_t>>& boards, std::atomic<std::size_t>& nextBoard,
+                  PerftEngine engine, PerftShard& shard) {
+	const std::size_t kBatchSize = 256;
+	GameField field;
+	for (std::size_t first = nextBoard.fetch_add(kBatchSize); first < boards.size(); first = nextBoard.fetch_add(kBatchSize)) {
+		for (std::size_t i = first; i < std::min(boards.size(), first + kBatchSize); i++) {
+			auto [board, count] = boards[i];
+			for (int m = 1; m <= 4; m++) {
+				int score = 0;
+				PackedBoard movedBoard = applyMovement(engine, field, board, (UserMovement)m, score);
+				if (movedBoard == board) {
+					continue;
+				}
+				for (int cell = 0; cell < 16; cell++) {
+					if (getBoardTile(movedBoard, cell % 4, cell / 4) != GameTileType::NoTile) {
+						continue;
+					}
+					for (PackedBoard tile = 1; tile <= 2; tile++) {
+						PackedBoard child = movedBoard | (tile << (4 * cell));
+						shard.partitions[hashBoard(child) % shard.partitions.size()][child] += count;
+						shard.scoreSum += count * (std::uint64_t)score;
+						shard.generatedCount++;
+					}
+				}
+			}
+		}
+	}
+}
+
+}
+
+std::vector<PerftLevel> runPerft(const PerftOptions& options) {
+	int threadCount = std::max(1, options.threadCount);
+	std::vector<PerftLevel> levels;
+	std::vector<std::pair<PackedBoard, std::uint64_t>> boards = { { options.board, 1 } };
+	for (int depth = 1; depth <= options.depth && !boards.empty(); depth++) {
+		auto startTime = std::chrono::steady_clock::now();
+		std::vector<PerftShard> shards(threadCount);
+		std::atomic<std::size_t> nextBoard(0);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < threadCount; t++) {
+			threads.emplace_back([&, t] {
+				shards[t].partitions.resize(threadCount);
+				expandBoards(boards, nextBoard, options.engine, shards[t]);
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		// partition 'p' of every shard goes into partition 'p' of the first one
+		threads.clear();
+		for (int p = 0; p < threadCount; p++) {
+			threads.emplace_back([&, p] {
+				PerftCounts& merged = shards[0].partitions[p];
+				for (int t = 1; t < threadCount; t++) {
+					for (auto& [board, count] : shards[t].partitions[p]) {
+						merged[board] += count;
+					}
+					PerftCounts().swap(shards[t].partitions[p]);
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+
+		PerftLevel level{
+			.depth = depth,
+			.nodeCount = 0,
+			.distinctCount = 0,
+			.generatedCount = 0,
+			.scoreSum = 0,
+			.seconds = 0,
+		};
+		for (auto& shard : shards) {
+			level.generatedCount += shard.generatedCount;
+			level.scoreSum += shard.scoreSum;
+		}
+		std::vector<std::pair<PackedBoard, std::uint64_t>> nextBoards;
+		for (auto& partition : shards[0].partitions) {
+			level.distinctCount += partition.size();
+			for (auto& entry : partition) {
+				level.nodeCount += entry.second;
+				nextBoards.push_back(entry);
+			}
+		}
+		boards = std::move(nextBoards);
+		level.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		levels.push_back(level);
+	}
+	return levels;
+}
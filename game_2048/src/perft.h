@@ -0,0 +1,46 @@
+#ifndef GAME_2048_PERFT_H
+#define GAME_2048_PERFT_H
+
+#include <cstdint>
+#include <vector>
+
+#include "board.h"
+
+enum class PerftEngine {
+	Table, // moveBoard()
+	Reference // GameField::requestMovement()
+};
+
+struct PerftOptions {
+	PackedBoard board;
+	int depth;
+	int threadCount;
+	PerftEngine engine;
+};
+
+// Totals of one ply, a ply is a movement that changes the board and then a spawn.
+struct PerftLevel {
+	int depth;
+	// Move and spawn sequences of 'depth' plies, sequences end early on a failed board.
+	std::uint64_t nodeCount;
+	std::uint64_t distinctCount;
+	// Boards generated before duplicates are merged: every spawn after every movement
+	// of every distinct board of the previous ply.
+	std::uint64_t generatedCount;
+	// Score of the last movement of every sequence, wraps around; a checksum of the merge rules.
+	std::uint64_t scoreSum;
+	double seconds;
+};
+
+/*
+	Enumerates every movement and every spawn (Tile2 and Tile4 on each empty tile) from
+	the board, for checking a move engine against GameField and for measuring it:
+	 - plies are expanded breadth-first, every distinct board once with the number of
+	   sequences that reach it, so the counts stay exact while the work stays small;
+	 - each thread expands a share of the ply into hash maps partitioned by board hash,
+	   then each thread merges one partition of all threads.
+	Engines must agree on every count of every ply.
+*/
+std::vector<PerftLevel> runPerft(const PerftOptions& options);
+
+#endif // GAME_2048_PERFT_H
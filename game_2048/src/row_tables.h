@@ -0,0 +1,61 @@
+#ifndef GAME_2048_ROW_TABLES_H
+#define GAME_2048_ROW_TABLES_H
+
+#include "board.h"
+
+// Results of left and right movements for all 65536 packed rows. Built by
+// constexpr evaluation, so the tables are part of the binary's read-only data
+// and cost nothing at startup. Note that the compilers need a raised constexpr
+// step limit for it (see CMakeLists.txt).
+
+struct RowTables {
+	PackedRow left[kRowCount];
+	PackedRow right[kRowCount];
+	int leftScore[kRowCount];
+	int rightScore[kRowCount];
+};
+
+constexpr PackedRow reverseRow(PackedRow row) {
+	return (PackedRow)((row >> 12) | ((row >> 4) & 0x00F0) | 
+	                   ((row << 4) & 0x0F00) | (row << 12));
+}
+
+// Same rules as moveFieldLine(): tiles slide to the left and every tile
+// can take part in only one merge per movement.
+constexpr PackedRow moveRowLeft(PackedRow row, int& score) {
+	int cells[4] = { row & 0xF, (row >> 4) & 0xF, (row >> 8) & 0xF, (row >> 12) & 0xF };
+	int result[4] = {};
+	int target = 0;
+	bool canMerge = false;
+	score = 0;
+	for (int i = 0; i < 4; i++) {
+		if (cells[i] == 0) {
+			continue;
+		}
+		// exponent 15 has no room to grow in 4 bits
+		if (canMerge && result[target - 1] == cells[i] && cells[i] < 15) {
+			result[target - 1]++;
+			score += 1 << result[target - 1];
+			canMerge = false;
+			continue;
+		}
+		result[target++] = cells[i];
+		canMerge = true;
+	}
+	return (PackedRow)(result[0] | (result[1] << 4) | (result[2] << 8) | (result[3] << 12));
+}
+
+constexpr RowTables buildRowTables() {
+	RowTables tables{};
+	for (int row = 0; row < kRowCount; row++) {
+		int score = 0;
+		PackedRow reversed = reverseRow((PackedRow)row);
+		tables.left[row] = moveRowLeft((PackedRow)row, score);
+		tables.leftScore[row] = score;
+		tables.right[reversed] = reverseRow(tables.left[row]);
+		tables.rightScore[reversed] = score;
+	}
+	return tables;
+}
+
+#endif // GAME_2048_ROW_TABLES_H
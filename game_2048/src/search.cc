@@ -0,0 +1,190 @@
+#include "search.h"
+
+#include <algorithm>
+
+#include "heuristic.h"
+#include "symmetry.h"
+
+// Chance nodes reached with lower probability are evaluated statically.
+const float kProbabilityCutoff = 0.0001f;
+// How many nodes are searched between stop condition checks.
+const long long kStopCheckInterval = 1024;
+
+float evaluateBoard(PackedBoard board) {
+	return getDefaultHeuristic().evaluate(board);
+}
+
+ExpectimaxSearch::ExpectimaxSearch() : evaluator(nullptr), isAfterstateEvaluator(false), nodeCount(0),
+	isAborted(false) {}
+
+float ExpectimaxSearch::evaluateLeaf(PackedBoard board) const {
+	return evaluator != nullptr ? evaluator->evaluate(board) : evaluateBoard(board);
+}
+
+bool ExpectimaxSearch::checkStop() {
+	if (!isAborted && shouldStop && (nodeCount % kStopCheckInterval) == 0) {
+		isAborted = shouldStop();
+	}
+	return isAborted;
+}
+
+SearchResult ExpectimaxSearch::findBestMove(PackedBoard board, int depth) {
+	RootMove moves[4] = {
+		{ .movement = UserMovement::Left, .value = 0, .isSearched = false },
+		{ .movement = UserMovement::Right, .value = 0, .isSearched = false },
+		{ .movement = UserMovement::Up, .value = 0, .isSearched = false },
+		{ .movement = UserMovement::Down, .value = 0, .isSearched = false },
+	};
+	cache.clear();
+	return searchRoot(board, depth, moves);
+}
+
+SearchResult ExpectimaxSearch::searchUntil(PackedBoard board, std::chrono::steady_clock::time_point deadline,
+                                           int maxDepth) {
+	RootMove moves[4] = {
+		{ .movement = UserMovement::Left, .value = 0, .isSearched = false },
+		{ .movement = UserMovement::Right, .value = 0, .isSearched = false },
+		{ .movement = UserMovement::Up, .value = 0, .isSearched = false },
+		{ .movement = UserMovement::Down, .value = 0, .isSearched = false },
+	};
+	// kept across the depths, an entry answers every search of its board that is not deeper
+	cache.clear();
+	SearchResult result = searchRoot(board, 1, moves);
+	long long totalNodeCount = result.nodeCount;
+	std::function<bool()> stopCondition = shouldStop;
+	shouldStop = [stopCondition, deadline] {
+		return (stopCondition && stopCondition()) || std::chrono::steady_clock::now() >= deadline;
+	};
+	for (int depth = 2; depth <= maxDepth && !result.isAborted && result.bestMovement != UserMovement::None; depth++) {
+		std::stable_sort(moves, moves + 4, [](const RootMove& a, const RootMove& b) {
+			return a.isSearched && (!b.isSearched || a.value > b.value);
+		});
+		SearchResult deeperResult = searchRoot(board, depth, moves);
+		totalNodeCount += deeperResult.nodeCount;
+		if (!deeperResult.isAborted) {
+			result = deeperResult;
+			continue;
+		}
+		// the previous best movement was searched first, the rest of this depth is compared to it
+		if (moves[0].isSearched) {
+			result.bestMovement = deeperResult.bestMovement;
+			result.value = deeperResult.value;
+		}
+		result.isAborted = stopCondition && stopCondition();
+		break;
+	}
+	shouldStop = stopCondition;
+	result.nodeCount = totalNodeCount;
+	return result;
+}
+
+SearchResult ExpectimaxSearch::searchRoot(PackedBoard board, int depth, RootMove moves[4]) {
+	nodeCount = 0;
+	isAborted = false;
+	SearchResult result{
+		.bestMovement = UserMovement::None,
+		.value = 0,
+		.nodeCount = 0,
+		.depth = depth,
+		.isAborted = false,
+	};
+	for (int i = 0; i < 4; i++) {
+		moves[i].isSearched = false;
+	}
+	for (int i = 0; i < 4 && !isAborted; i++) {
+		int score = 0;
+		PackedBoard movedBoard = moveBoard(board, moves[i].movement, &score);
+		if (movedBoard == board) {
+			continue;
+		}
+		float value = evaluateSpawn(movedBoard, depth, 1.0f);
+		if (isAborted) {
+			break;
+		}
+		if (isAfterstateEvaluator) {
+			value += score;
+		}
+		moves[i].value = value;
+		moves[i].isSearched = true;
+		if (result.bestMovement == UserMovement::None || value > result.value) {
+			result.bestMovement = moves[i].movement;
+			result.value = value;
+		}
+	}
+	result.nodeCount = nodeCount;
+	result.isAborted = isAborted;
+	return result;
+}
+
+// Player to move: take the best of the available movements.
+// An afterstate value function is evaluated one movement further, at the chance node
+// of depth 0, and the score of the movement is added to it.
+float ExpectimaxSearch::evaluateMove(PackedBoard board, int depth, float probability) {
+	nodeCount++;
+	if (checkStop()) {
+		return 0;
+	}
+	if (depth == 0 || probability < kProbabilityCutoff) {
+		if (!isAfterstateEvaluator) {
+			return evaluateLeaf(board);
+		}
+		depth = 0;
+	}
+	float bestValue = 0;
+	for (int i = (int)UserMovement::Left; i <= (int)UserMovement::Down; i++) {
+		int score = 0;
+		PackedBoard movedBoard = moveBoard(board, (UserMovement)i, &score);
+		if (movedBoard == board) {
+			continue;
+		}
+		float value = evaluateSpawn(movedBoard, depth, probability);
+		if (isAfterstateEvaluator) {
+			value += score;
+		}
+		if (value > bestValue) {
+			bestValue = value;
+		}
+	}
+	return bestValue;
+}
+
+// New tile spawns: average over every empty tile and both tile types.
+float ExpectimaxSearch::evaluateSpawn(PackedBoard board, int depth, float probability) {
+	nodeCount++;
+	if (checkStop()) {
+		return 0;
+	}
+	if (depth == 0) {
+		return evaluateLeaf(board);
+	}
+	// symmetric boards have the same value, they share one cache entry
+	PackedBoard cacheKey = canonicalizeBoard(board).board;
+	auto cached = cache.find(cacheKey);
+	if (cached != cache.end() && cached->second.depth >= depth) {
+		return cached->second.value;
+	}
+	int emptyCount = countEmptyTiles(board);
+	if (emptyCount == 0) {
+		return evaluateLeaf(board);
+	}
+	float tileProbability = probability / emptyCount;
+	float value = 0;
+	for (int y = 0; y < 4; y++) {
+		for (int x = 0; x < 4; x++) {
+			if (getBoardTile(board, x, y) != GameTileType::NoTile) {
+				continue;
+			}
+			PackedBoard board2 = setBoardTile(board, x, y, GameTileType::Tile2);
+			PackedBoard board4 = setBoardTile(board, x, y, GameTileType::Tile4);
+			value += (1.0f - kTile4SpawnProbability) * 
+				evaluateMove(board2, depth - 1, tileProbability * (1.0f - kTile4SpawnProbability));
+			value += kTile4SpawnProbability * 
+				evaluateMove(board4, depth - 1, tileProbability * kTile4SpawnProbability);
+		}
+	}
+	value /= emptyCount;
+	if (!isAborted) {
+		cache[cacheKey] = CacheEntry{ .depth = depth, .value = value };
+	}
+	return value;
+}
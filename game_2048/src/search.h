@@ -0,0 +1,87 @@
+#ifndef GAME_2048_SEARCH_H
+#define GAME_2048_SEARCH_H
+
+#include <chrono>
+#include <functional>
+#include <unordered_map>
+
+#include "board.h"
+
+const int kDefaultSearchDepth = 3;
+
+struct SearchResult {
+	UserMovement bestMovement;
+	float value;
+	long long nodeCount;
+	int depth; // deepest look-ahead searched for every movement, 0 - not a search
+	bool isAborted;
+};
+
+// Heuristic value of a board, higher is better.
+float evaluateBoard(PackedBoard board);
+
+// Replaces evaluateBoard() at the leaves of the search.
+class IBoardEvaluator {
+public:
+	virtual ~IBoardEvaluator() = default;
+	virtual float evaluate(PackedBoard board) const = 0;
+	// True for value functions of afterstates (boards after a movement, before the spawn)
+	// that estimate the score still to come. The search then adds the score of every
+	// movement and evaluates afterstates instead of boards after a spawn.
+	virtual bool isAfterstateValue() const { return false; }
+};
+
+// Expectimax over the player moves and random tile spawns of PackedBoard.
+class ExpectimaxSearch {
+private:
+	struct CacheEntry {
+		int depth;
+		float value;
+	};
+
+	struct RootMove {
+		UserMovement movement;
+		float value;
+		bool isSearched; // at the depth of the last searchRoot()
+	};
+
+	std::function<bool()> shouldStop;
+	const IBoardEvaluator* evaluator;
+	bool isAfterstateEvaluator; // evaluator->isAfterstateValue(), read at every node
+	std::unordered_map<PackedBoard, CacheEntry> cache;
+	long long nodeCount;
+	bool isAborted;
+
+	bool checkStop();
+	// Searches the movements in the given order, stops at the first aborted one.
+	// The cache is left to the caller, so the depths of searchUntil() share it.
+	SearchResult searchRoot(PackedBoard board, int depth, RootMove moves[4]);
+	float evaluateLeaf(PackedBoard board) const;
+	float evaluateMove(PackedBoard board, int depth, float probability);
+	float evaluateSpawn(PackedBoard board, int depth, float probability);
+
+public:
+	ExpectimaxSearch();
+
+	// Polled during the search, the search is aborted once it returns true.
+	void setStopCondition(std::function<bool()> condition) { shouldStop = condition; }
+	// nullptr means evaluateBoard(). The evaluator must outlive the searches.
+	void setEvaluator(const IBoardEvaluator* newEvaluator) {
+		evaluator = newEvaluator;
+		isAfterstateEvaluator = evaluator != nullptr && evaluator->isAfterstateValue();
+	}
+
+	// 'depth' is the count of player moves to look ahead.
+	SearchResult findBestMove(PackedBoard board, int depth);
+	/*
+		Anytime search: deepens one player move at a time until the deadline or 'maxDepth',
+		the stop condition aborts it as before.
+		 - depth 1 ignores the deadline, so there is always a movement to play;
+		 - every depth searches the best movement of the previous one first, and if the
+		   deadline comes in the middle of a depth, its finished movements still count;
+		 - nodeCount is the total of all depths, depth the last one that was finished.
+	*/
+	SearchResult searchUntil(PackedBoard board, std::chrono::steady_clock::time_point deadline, int maxDepth);
+};
+
+#endif // GAME_2048_SEARCH_H
@@ -0,0 +1,35 @@
+#include "self_play.h"
+
+#include "logic.h"
+
+SelfPlayResult playSelfPlayGame(ExpectimaxSearch& search, FastRandom& random, int searchDepth,
+                                const std::function<void(const SelfPlayMove&)>& onMove) {
+	GameField field;
+	field.spawnNewTiles();
+	int moveCount = 0;
+	while (!field.isGameFailed()) {
+		PackedBoard board = field.getBoard();
+		UserMovement movement = UserMovement::None;
+		if (searchDepth > 0) {
+			movement = search.findBestMove(board, searchDepth).bestMovement;
+		}
+		else {
+			// the first movement that changes the board, starting from a random one
+			int first = (int)(random.next() % 4);
+			for (int i = 0; i < 4 && movement == UserMovement::None; i++) {
+				UserMovement candidate = (UserMovement)((first + i) % 4 + 1);
+				if (moveBoard(board, candidate) != board) {
+					movement = candidate;
+				}
+			}
+		}
+		int score = field.getScore();
+		if (movement == UserMovement::None || field.requestMovement(movement).empty()) {
+			break;
+		}
+		moveCount++;
+		onMove(SelfPlayMove{ .board = board, .movement = movement, .scoreGained = field.getScore() - score });
+		field.spawnNewTiles();
+	}
+	return SelfPlayResult{ .score = field.getScore(), .moveCount = moveCount, .maxTile = field.getMaxTile() };
+}
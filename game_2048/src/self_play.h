@@ -0,0 +1,29 @@
+#ifndef GAME_2048_SELF_PLAY_H
+#define GAME_2048_SELF_PLAY_H
+
+#include <functional>
+
+#include "board.h"
+#include "search.h"
+
+struct SelfPlayMove {
+	PackedBoard board; // before the movement
+	UserMovement movement;
+	int scoreGained;
+};
+
+struct SelfPlayResult {
+	int score;
+	int moveCount;
+	GameTileType maxTile;
+};
+
+/*
+	Plays one GameField game from a two-tile start, for the offline tools.
+	'searchDepth' 0 plays random movements, otherwise expectimax of that depth.
+	'onMove' is called after every movement that was made, before its spawn.
+*/
+SelfPlayResult playSelfPlayGame(ExpectimaxSearch& search, FastRandom& random, int searchDepth,
+                                const std::function<void(const SelfPlayMove&)>& onMove);
+
+#endif // GAME_2048_SELF_PLAY_H
@@ -0,0 +1,67 @@
+#include "settings.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+#include "config_file.h"
+
+namespace {
+
+bool readSetting(GameSettings& settings, const std::string& name, std::istream& value) {
+	int number = 0;
+	if (!(value >> number)) {
+		return false;
+	}
+	if (name == "framerate") {
+		settings.framerate = std::max(0, number);
+	}
+	else if (name == "vsync") {
+		settings.isVsyncEnabled = number != 0;
+	}
+	else if (name == "msaa") {
+		settings.isMsaaEnabled = number != 0;
+	}
+	else if (name == "animation_duration") {
+		settings.animationDuration = std::max(0, number);
+	}
+	else if (name == "ai_think_time") {
+		settings.aiThinkTime = std::max(0, number);
+	}
+	else {
+		return false;
+	}
+	return true;
+}
+
+}
+
+bool loadSettings(const std::string& path, GameSettings& settings) {
+	GameSettings newSettings = settings;
+	bool isRead = readConfigFile(path, [&newSettings](const std::string& name, std::istream& value) {
+		return readSetting(newSettings, name, value);
+	});
+	if (isRead) {
+		settings = newSettings;
+	}
+	return isRead;
+}
+
+bool saveSettings(const std::string& path, const GameSettings& settings) {
+	std::ofstream file(path);
+	file << "framerate " << settings.framerate << "\n"
+	     << "vsync " << (settings.isVsyncEnabled ? 1 : 0) << "\n"
+	     << "msaa " << (settings.isMsaaEnabled ? 1 : 0) << "\n"
+	     << "animation_duration " << settings.animationDuration << "\n"
+	     << "ai_think_time " << settings.aiThinkTime << "\n";
+	return (bool)file;
+}
+
+GameSettings loadStartupSettings() {
+	GameSettings settings;
+	std::ifstream file(kSettingsFile);
+	if (file && !loadSettings(kSettingsFile, settings)) {
+		std::cout << "Failed to load " << kSettingsFile << ", using the defaults" << std::endl;
+	}
+	return settings;
+}
@@ -0,0 +1,28 @@
+#ifndef GAME_2048_SETTINGS_H
+#define GAME_2048_SETTINGS_H
+
+#include <string>
+
+// Read at startup and rewritten whenever a setting is changed in the settings screen.
+const std::string kSettingsFile = "settings.txt";
+
+// Values offered by the settings screen, a click moves to the next one.
+const int kFramerateOptions[] = { 30, 60, 144, 240, 0 };
+const int kAnimationDurationOptions[] = { 0, 70, 140, 280 };
+const int kAIThinkTimeOptions[] = { 0, 20, 50, 100, 250 };
+
+struct GameSettings {
+	int framerate = 144; // frames per second, 0 - uncapped
+	bool isVsyncEnabled = false;
+	bool isMsaaEnabled = true; // applied at the next start, the window is created with it
+	int animationDuration = 140; // milliseconds of a tile movement, 0 - no animations
+	int aiThinkTime = 0; // milliseconds the AI may deepen its search, 0 - fixed depth
+};
+
+// Read with readConfigFile(), settings missing from the file are left unchanged.
+bool loadSettings(const std::string& path, GameSettings& settings);
+bool saveSettings(const std::string& path, const GameSettings& settings);
+// Default settings, overridden by kSettingsFile if it exists.
+GameSettings loadStartupSettings();
+
+#endif // GAME_2048_SETTINGS_H
@@ -0,0 +1,450 @@
+#include "solver.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+const char kTableInfoMagic[8] = { '2', '0', '4', '8', 'E', 'X', 'C', 'T' };
+const std::uint32_t kTableInfoVersion = 1;
+const char* const kTableInfoFile = "table.info";
+// States handed to a worker thread at once.
+const std::size_t kSolverBlockSize = 4096;
+// Boards read ahead from every run while merging.
+const std::size_t kMergeReadBuffer = 4096;
+
+namespace {
+
+int getTileSum(PackedBoard board) {
+	int sum = 0;
+	for (int i = 0; i < 16; i++) {
+		int tile = (int)((board >> (4 * i)) & 0xF);
+		if (tile != 0) {
+			sum += 1 << tile;
+		}
+	}
+	return sum;
+}
+
+// Mirror the top left 'width' columns left to right.
+PackedBoard mirrorColumns(PackedBoard board, int width) {
+	return flipBoardHorizontally(board) >> (4 * (4 - width));
+}
+
+// Mirror the top 'height' rows top to bottom.
+PackedBoard mirrorRows(PackedBoard board, int height) {
+	return flipBoardVertically(board) >> (16 * (4 - height));
+}
+
+const PackedBoard* getBoards(const MappedFile& file) {
+	return (const PackedBoard*)file.getData();
+}
+
+std::size_t getBoardCount(const MappedFile& file) {
+	return file.getSize() / sizeof(PackedBoard);
+}
+
+bool findValue(const MappedFile& states, const MappedFile& values, PackedBoard board, double& value) {
+	const PackedBoard* begin = getBoards(states);
+	const PackedBoard* end = begin + getBoardCount(states);
+	const PackedBoard* found = std::lower_bound(begin, end, board);
+	if (found == end || *found != board) {
+		return false;
+	}
+	value = ((const double*)values.getData())[found - begin];
+	return true;
+}
+
+// Run 'work' for every block of 'count' items on all threads.
+template <typename Work>
+void runParallel(std::size_t count, int threadCount, Work work) {
+	std::atomic<std::size_t> nextBlock(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; t++) {
+		threads.emplace_back([&, t] {
+			while (true) {
+				std::size_t begin = nextBlock.fetch_add(kSolverBlockSize);
+				if (begin >= count) {
+					break;
+				}
+				work(t, begin, std::min(count, begin + kSolverBlockSize));
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+}
+
+PackedBoard moveSmallBoard(PackedBoard board, int width, int height, UserMovement movement, int* scoreGained) {
+	// tiles only slide towards index 0, so left and up never leave the small board
+	switch (movement) {
+	case UserMovement::Left:
+	case UserMovement::Up:
+		return moveBoard(board, movement, scoreGained);
+	case UserMovement::Right:
+		return mirrorColumns(moveBoard(mirrorColumns(board, width), UserMovement::Left, scoreGained), width);
+	case UserMovement::Down:
+		return mirrorRows(moveBoard(mirrorRows(board, height), UserMovement::Up, scoreGained), height);
+	default:
+		return board;
+	}
+}
+
+SmallBoardSolver::SmallBoardSolver(const SolverOptions& options) : options(options) {}
+
+std::string SmallBoardSolver::getLayerPath(int sum, const char* extension) const {
+	return options.directory + "/layer_" + std::to_string(sum) + extension;
+}
+
+std::string SmallBoardSolver::getRunPath(int sum, int run) const {
+	return options.directory + "/layer_" + std::to_string(sum) + ".run" + std::to_string(run);
+}
+
+bool SmallBoardSolver::isTerminalWin(PackedBoard board) const {
+	return options.objective == SolverObjective::Win && getMaxTile(board) >= options.targetTile;
+}
+
+void SmallBoardSolver::writeRun(int sum, std::vector<PackedBoard>& boards) {
+	if (boards.empty()) {
+		return;
+	}
+	std::sort(boards.begin(), boards.end());
+	boards.erase(std::unique(boards.begin(), boards.end()), boards.end());
+	int run = 0;
+	{
+		std::lock_guard<std::mutex> lock(runMutex);
+		run = runCounts[sum]++;
+	}
+	std::ofstream file(getRunPath(sum, run), std::ios::binary);
+	file.write((const char*)boards.data(), boards.size() * sizeof(PackedBoard));
+	boards.clear();
+}
+
+// k-way merge of the sorted runs of a layer into its states file.
+bool SmallBoardSolver::mergeRuns(int sum, std::uint64_t& stateCount) {
+	struct RunReader {
+		std::ifstream file;
+		std::vector<PackedBoard> buffer;
+		std::size_t position;
+
+		bool next(PackedBoard& board) {
+			if (position == buffer.size()) {
+				buffer.resize(kMergeReadBuffer);
+				file.read((char*)buffer.data(), kMergeReadBuffer * sizeof(PackedBoard));
+				buffer.resize((std::size_t)file.gcount() / sizeof(PackedBoard));
+				position = 0;
+				if (buffer.empty()) {
+					return false;
+				}
+			}
+			board = buffer[position++];
+			return true;
+		}
+	};
+	int runCount = runCounts[sum];
+	std::vector<RunReader> readers(runCount);
+	using HeapItem = std::pair<PackedBoard, int>;
+	std::priority_queue<HeapItem, std::vector<HeapItem>, std::greater<HeapItem>> heap;
+	for (int run = 0; run < runCount; run++) {
+		readers[run].file.open(getRunPath(sum, run), std::ios::binary);
+		readers[run].position = 0;
+		PackedBoard board;
+		if (readers[run].next(board)) {
+			heap.push({ board, run });
+		}
+	}
+	std::ofstream output(getLayerPath(sum, ".states"), std::ios::binary);
+	std::vector<PackedBoard> outputBuffer;
+	outputBuffer.reserve(kMergeReadBuffer);
+	stateCount = 0;
+	bool hasLast = false;
+	PackedBoard last = 0;
+	while (!heap.empty()) {
+		auto [board, run] = heap.top();
+		heap.pop();
+		if (!hasLast || board != last) {
+			outputBuffer.push_back(board);
+			stateCount++;
+			last = board;
+			hasLast = true;
+			if (outputBuffer.size() == kMergeReadBuffer) {
+				output.write((const char*)outputBuffer.data(), outputBuffer.size() * sizeof(PackedBoard));
+				outputBuffer.clear();
+			}
+		}
+		PackedBoard nextBoard;
+		if (readers[run].next(nextBoard)) {
+			heap.push({ nextBoard, run });
+		}
+	}
+	output.write((const char*)outputBuffer.data(), outputBuffer.size() * sizeof(PackedBoard));
+	readers.clear();
+	for (int run = 0; run < runCount; run++) {
+		std::remove(getRunPath(sum, run).c_str());
+	}
+	runCounts.erase(sum);
+	return (bool)output;
+}
+
+bool SmallBoardSolver::expandLayer(int sum) {
+	MappedFile states;
+	if (!states.openForReading(getLayerPath(sum, ".states"))) {
+		return false;
+	}
+	const PackedBoard* boards = getBoards(states);
+	std::size_t bufferCapacity = std::max<std::size_t>(kSolverBlockSize, 
+		options.memoryBudget / (2 * options.threadCount * sizeof(PackedBoard)));
+	std::vector<std::vector<PackedBoard>> buffers2(options.threadCount);
+	std::vector<std::vector<PackedBoard>> buffers4(options.threadCount);
+	runParallel(getBoardCount(states), options.threadCount, [&](int thread, std::size_t begin, std::size_t end) {
+		auto& buffer2 = buffers2[thread];
+		auto& buffer4 = buffers4[thread];
+		for (std::size_t i = begin; i < end; i++) {
+			if (isTerminalWin(boards[i])) {
+				continue;
+			}
+			for (int m = (int)UserMovement::Left; m <= (int)UserMovement::Down; m++) {
+				PackedBoard moved = moveSmallBoard(boards[i], options.width, options.height, 
+				                                   (UserMovement)m, nullptr);
+				if (moved == boards[i]) {
+					continue;
+				}
+				for (int y = 0; y < options.height; y++) {
+					for (int x = 0; x < options.width; x++) {
+						if (getBoardTile(moved, x, y) == GameTileType::NoTile) {
+							buffer2.push_back(setBoardTile(moved, x, y, GameTileType::Tile2));
+							buffer4.push_back(setBoardTile(moved, x, y, GameTileType::Tile4));
+						}
+					}
+				}
+			}
+			if (buffer2.size() >= bufferCapacity) {
+				writeRun(sum + 2, buffer2);
+			}
+			if (buffer4.size() >= bufferCapacity) {
+				writeRun(sum + 4, buffer4);
+			}
+		}
+	});
+	for (int t = 0; t < options.threadCount; t++) {
+		writeRun(sum + 2, buffers2[t]);
+		writeRun(sum + 4, buffers4[t]);
+	}
+	return true;
+}
+
+// Retrograde step: the layers sum + 2 and sum + 4 are already solved.
+bool SmallBoardSolver::solveLayer(int sum) {
+	MappedFile states;
+	MappedFile values;
+	MappedFile nextStates[2];
+	MappedFile nextValues[2];
+	if (!states.openForReading(getLayerPath(sum, ".states")) ||
+	    !values.createForWriting(getLayerPath(sum, ".values"), getBoardCount(states) * sizeof(double))) {
+		return false;
+	}
+	for (int i = 0; i < 2; i++) {
+		// a missing layer only means that no position leads there
+		nextStates[i].openForReading(getLayerPath(sum + 2 * (i + 1), ".states"));
+		nextValues[i].openForReading(getLayerPath(sum + 2 * (i + 1), ".values"));
+	}
+	const PackedBoard* boards = getBoards(states);
+	double* boardValues = (double*)values.getWritableData();
+	std::atomic<long long> missingStates(0);
+	runParallel(getBoardCount(states), options.threadCount, [&](int, std::size_t begin, std::size_t end) {
+		for (std::size_t i = begin; i < end; i++) {
+			if (isTerminalWin(boards[i])) {
+				boardValues[i] = 1.0;
+				continue;
+			}
+			double bestValue = 0;
+			for (int m = (int)UserMovement::Left; m <= (int)UserMovement::Down; m++) {
+				int score = 0;
+				PackedBoard moved = moveSmallBoard(boards[i], options.width, options.height, 
+				                                   (UserMovement)m, &score);
+				if (moved == boards[i]) {
+					continue;
+				}
+				double value = 0;
+				int emptyCount = 0;
+				for (int y = 0; y < options.height; y++) {
+					for (int x = 0; x < options.width; x++) {
+						if (getBoardTile(moved, x, y) != GameTileType::NoTile) {
+							continue;
+						}
+						double value2 = 0;
+						double value4 = 0;
+						if (!findValue(nextStates[0], nextValues[0], setBoardTile(moved, x, y, GameTileType::Tile2), value2) ||
+						    !findValue(nextStates[1], nextValues[1], setBoardTile(moved, x, y, GameTileType::Tile4), value4)) {
+							missingStates++;
+						}
+						value += (1.0 - kTile4SpawnProbability) * value2 + kTile4SpawnProbability * value4;
+						emptyCount++;
+					}
+				}
+				value /= emptyCount;
+				if (options.objective == SolverObjective::Score) {
+					value += score;
+				}
+				bestValue = std::max(bestValue, value);
+			}
+			boardValues[i] = bestValue;
+		}
+	});
+	if (missingStates > 0) {
+		std::cerr << "layer " << sum << ": " << missingStates << " successors not found" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool SmallBoardSolver::build() {
+	if (options.width < 2 || options.width > 4 || options.height < 2 || options.height > 4 || 
+	    options.threadCount < 1) {
+		return false;
+	}
+	std::error_code error;
+	std::filesystem::create_directories(options.directory, error);
+	runCounts.clear();
+	layerSums.clear();
+
+	// the first two tiles of a game
+	std::map<int, std::vector<PackedBoard>> startBoards;
+	int cellCount = options.width * options.height;
+	for (int first = 0; first < cellCount; first++) {
+		for (int second = 0; second < cellCount; second++) {
+			if (first == second) {
+				continue;
+			}
+			for (int firstTile = 1; firstTile <= 2; firstTile++) {
+				for (int secondTile = 1; secondTile <= 2; secondTile++) {
+					PackedBoard board = setBoardTile(0, first % options.width, first / options.width, 
+					                                 (GameTileType)firstTile);
+					board = setBoardTile(board, second % options.width, second / options.width, 
+					                     (GameTileType)secondTile);
+					startBoards[getTileSum(board)].push_back(board);
+				}
+			}
+		}
+	}
+	for (auto& [sum, boards] : startBoards) {
+		writeRun(sum, boards);
+	}
+
+	for (int sum = 4; !runCounts.empty(); sum += 2) {
+		if (runCounts.count(sum) == 0) {
+			continue;
+		}
+		std::uint64_t stateCount = 0;
+		if (!mergeRuns(sum, stateCount) || !expandLayer(sum)) {
+			return false;
+		}
+		layerSums.push_back(sum);
+		std::cout << "layer " << sum << ": " << stateCount << " states" << std::endl;
+	}
+	for (auto sum = layerSums.rbegin(); sum != layerSums.rend(); sum++) {
+		if (!solveLayer(*sum)) {
+			return false;
+		}
+	}
+
+	std::ofstream info(options.directory + "/" + kTableInfoFile, std::ios::binary);
+	std::int32_t header[4] = { options.width, options.height, (std::int32_t)options.objective, 
+	                           (std::int32_t)options.targetTile };
+	std::uint32_t layerCount = (std::uint32_t)layerSums.size();
+	info.write(kTableInfoMagic, sizeof(kTableInfoMagic));
+	info.write((const char*)&kTableInfoVersion, sizeof(kTableInfoVersion));
+	info.write((const char*)header, sizeof(header));
+	info.write((const char*)&layerCount, sizeof(layerCount));
+	info.write((const char*)layerSums.data(), layerSums.size() * sizeof(int));
+	return (bool)info;
+}
+
+bool ExactValueTable::open(const std::string& directory) {
+	std::ifstream info(directory + "/" + kTableInfoFile, std::ios::binary);
+	char magic[sizeof(kTableInfoMagic)];
+	std::uint32_t version = 0;
+	std::int32_t header[4];
+	std::uint32_t layerCount = 0;
+	if (!info.read(magic, sizeof(magic)) || std::memcmp(magic, kTableInfoMagic, sizeof(magic)) != 0 ||
+	    !info.read((char*)&version, sizeof(version)) || version != kTableInfoVersion ||
+	    !info.read((char*)header, sizeof(header)) || !info.read((char*)&layerCount, sizeof(layerCount))) {
+		return false;
+	}
+	std::vector<int> sums(layerCount);
+	if (!info.read((char*)sums.data(), layerCount * sizeof(int))) {
+		return false;
+	}
+	options = SolverOptions{
+		.width = header[0],
+		.height = header[1],
+		.objective = (SolverObjective)header[2],
+		.targetTile = (GameTileType)header[3],
+		.threadCount = 1,
+		.memoryBudget = 0,
+		.directory = directory,
+	};
+	layers.clear();
+	for (int sum : sums) {
+		Layer& layer = layers[sum];
+		std::string path = directory + "/layer_" + std::to_string(sum);
+		if (!layer.states.openForReading(path + ".states") || 
+		    !layer.values.openForReading(path + ".values")) {
+			layers.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ExactValueTable::lookup(PackedBoard board, double& value) const {
+	auto layer = layers.find(getTileSum(board));
+	if (layer == layers.end()) {
+		return false;
+	}
+	return findValue(layer->second.states, layer->second.values, board, value);
+}
+
+double ExactValueTable::getStartValue() const {
+	int cellCount = options.width * options.height;
+	double startValue = 0;
+	for (int first = 0; first < cellCount; first++) {
+		for (int second = 0; second < cellCount; second++) {
+			if (first == second) {
+				continue;
+			}
+			for (int firstTile = 1; firstTile <= 2; firstTile++) {
+				for (int secondTile = 1; secondTile <= 2; secondTile++) {
+					PackedBoard board = setBoardTile(0, first % options.width, first / options.width, 
+					                                 (GameTileType)firstTile);
+					board = setBoardTile(board, second % options.width, second / options.width, 
+					                     (GameTileType)secondTile);
+					double probability = 1.0 / (cellCount * (cellCount - 1));
+					probability *= firstTile == 1 ? 1.0 - kTile4SpawnProbability : kTile4SpawnProbability;
+					probability *= secondTile == 1 ? 1.0 - kTile4SpawnProbability : kTile4SpawnProbability;
+					double value = 0;
+					lookup(board, value);
+					startValue += probability * value;
+				}
+			}
+		}
+	}
+	return startValue;
+}
+
+std::uint64_t ExactValueTable::getStateCount() const {
+	std::uint64_t count = 0;
+	for (const auto& [sum, layer] : layers) {
+		count += getBoardCount(layer.states);
+	}
+	return count;
+}
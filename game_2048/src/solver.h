@@ -0,0 +1,90 @@
+#ifndef GAME_2048_SOLVER_H
+#define GAME_2048_SOLVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "mapped_file.h"
+
+enum class SolverObjective {
+	Score = 0, // expected score gained from the position under optimal play
+	Win, // probability to reach the target tile under optimal play
+};
+
+struct SolverOptions {
+	int width;
+	int height;
+	SolverObjective objective;
+	GameTileType targetTile; // only for SolverObjective::Win
+	int threadCount;
+	std::size_t memoryBudget; // bytes of state buffers, the tables themselves live on disk
+	std::string directory;
+};
+
+// GameField rules on the top left 'width' x 'height' tiles of a PackedBoard, the rest stays empty.
+PackedBoard moveSmallBoard(PackedBoard board, int width, int height, UserMovement movement, int* scoreGained);
+
+/*
+	Exact values of all reachable positions of a small board, one pair of
+	files per layer of positions with the same sum of tiles:
+	 - layer_<sum>.states - sorted unique boards, the index of the layer;
+	 - layer_<sum>.values - double per board, in the same order.
+	Every spawn adds 2 or 4 to the sum and movements keep it, so a position
+	only leads to the layers sum + 2 and sum + 4. That gives both passes of
+	the build with only three layers in use at once:
+	 - forward: layers are enumerated in ascending order, successors are
+	   collected in bounded buffers, spilled to disk as sorted runs and merged
+	   into the next layer once all of its predecessors are expanded;
+	 - backward (retrograde analysis): layers are solved in descending order
+	   from the already solved layers above them.
+*/
+class SmallBoardSolver {
+private:
+	SolverOptions options;
+
+	std::map<int, int> runCounts; // layer sum -> count of spilled runs
+	std::mutex runMutex;
+	std::vector<int> layerSums;
+
+	std::string getLayerPath(int sum, const char* extension) const;
+	std::string getRunPath(int sum, int run) const;
+
+	void writeRun(int sum, std::vector<PackedBoard>& boards);
+	bool mergeRuns(int sum, std::uint64_t& stateCount);
+	bool expandLayer(int sum);
+	bool solveLayer(int sum);
+	bool isTerminalWin(PackedBoard board) const;
+
+public:
+	explicit SmallBoardSolver(const SolverOptions& options);
+
+	bool build();
+};
+
+// Read-only access to a table built by SmallBoardSolver.
+class ExactValueTable {
+private:
+	struct Layer {
+		MappedFile states;
+		MappedFile values;
+	};
+
+	SolverOptions options;
+	std::map<int, Layer> layers;
+
+public:
+	bool open(const std::string& directory);
+
+	const SolverOptions& getOptions() const { return options; }
+	bool lookup(PackedBoard board, double& value) const;
+	// Expected value over the random two-tile start of a new game.
+	double getStartValue() const;
+	std::uint64_t getStateCount() const;
+};
+
+#endif // GAME_2048_SOLVER_H
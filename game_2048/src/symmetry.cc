@@ -0,0 +1,132 @@
+#include "symmetry.h"
+
+PackedBoard transformBoard(PackedBoard board, int transform) {
+	if ((transform & kTransformTranspose) != 0) {
+		board = transposeBoard(board);
+	}
+	if ((transform & kTransformFlipHorizontally) != 0) {
+		board = flipBoardHorizontally(board);
+	}
+	if ((transform & kTransformFlipVertically) != 0) {
+		board = flipBoardVertically(board);
+	}
+	return board;
+}
+
+PackedBoard untransformBoard(PackedBoard board, int transform) {
+	if ((transform & kTransformFlipVertically) != 0) {
+		board = flipBoardVertically(board);
+	}
+	if ((transform & kTransformFlipHorizontally) != 0) {
+		board = flipBoardHorizontally(board);
+	}
+	if ((transform & kTransformTranspose) != 0) {
+		board = transposeBoard(board);
+	}
+	return board;
+}
+
+namespace {
+
+UserMovement transposeMovement(UserMovement movement) {
+	switch (movement) {
+	case UserMovement::Left:
+		return UserMovement::Up;
+	case UserMovement::Up:
+		return UserMovement::Left;
+	case UserMovement::Right:
+		return UserMovement::Down;
+	case UserMovement::Down:
+		return UserMovement::Right;
+	default:
+		return movement;
+	}
+}
+
+UserMovement flipMovementHorizontally(UserMovement movement) {
+	switch (movement) {
+	case UserMovement::Left:
+		return UserMovement::Right;
+	case UserMovement::Right:
+		return UserMovement::Left;
+	default:
+		return movement;
+	}
+}
+
+UserMovement flipMovementVertically(UserMovement movement) {
+	switch (movement) {
+	case UserMovement::Up:
+		return UserMovement::Down;
+	case UserMovement::Down:
+		return UserMovement::Up;
+	default:
+		return movement;
+	}
+}
+
+}
+
+UserMovement transformMovement(UserMovement movement, int transform) {
+	if ((transform & kTransformTranspose) != 0) {
+		movement = transposeMovement(movement);
+	}
+	if ((transform & kTransformFlipHorizontally) != 0) {
+		movement = flipMovementHorizontally(movement);
+	}
+	if ((transform & kTransformFlipVertically) != 0) {
+		movement = flipMovementVertically(movement);
+	}
+	return movement;
+}
+
+UserMovement untransformMovement(UserMovement movement, int transform) {
+	if ((transform & kTransformFlipVertically) != 0) {
+		movement = flipMovementVertically(movement);
+	}
+	if ((transform & kTransformFlipHorizontally) != 0) {
+		movement = flipMovementHorizontally(movement);
+	}
+	if ((transform & kTransformTranspose) != 0) {
+		movement = transposeMovement(movement);
+	}
+	return movement;
+}
+
+void getSymmetricBoards(PackedBoard board, PackedBoard boards[kBoardTransformCount]) {
+	PackedBoard transposed = transposeBoard(board);
+	boards[0] = board;
+	boards[kTransformFlipHorizontally] = flipBoardHorizontally(board);
+	boards[kTransformFlipVertically] = flipBoardVertically(board);
+	boards[kTransformFlipHorizontally | kTransformFlipVertically] = 
+		flipBoardVertically(boards[kTransformFlipHorizontally]);
+	boards[kTransformTranspose] = transposed;
+	boards[kTransformTranspose | kTransformFlipHorizontally] = flipBoardHorizontally(transposed);
+	boards[kTransformTranspose | kTransformFlipVertically] = flipBoardVertically(transposed);
+	boards[kTransformTranspose | kTransformFlipHorizontally | kTransformFlipVertically] =
+		flipBoardVertically(boards[kTransformTranspose | kTransformFlipHorizontally]);
+}
+
+CanonicalBoard canonicalizeBoard(PackedBoard board) {
+	PackedBoard boards[kBoardTransformCount];
+	getSymmetricBoards(board, boards);
+	CanonicalBoard canonical{ .board = board, .transform = 0 };
+	for (int i = 1; i < kBoardTransformCount; i++) {
+		if (boards[i] < canonical.board) {
+			canonical = CanonicalBoard{ .board = boards[i], .transform = i };
+		}
+	}
+	return canonical;
+}
+
+// splitmix64 finalizer
+std::uint64_t hashBoard(PackedBoard board) {
+	std::uint64_t hash = board;
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+	return hash ^ (hash >> 31);
+}
+
+std::uint64_t getCanonicalHash(PackedBoard board) {
+	return hashBoard(canonicalizeBoard(board).board);
+}
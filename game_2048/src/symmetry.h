@@ -0,0 +1,40 @@
+#ifndef GAME_2048_SYMMETRY_H
+#define GAME_2048_SYMMETRY_H
+
+#include <cstdint>
+
+#include "board.h"
+
+// The 8 symmetries of the square field. A transform is 3 bits, applied in
+// this order: transpose (bit 2), mirror left to right (bit 0), mirror top to bottom (bit 1).
+const int kBoardTransformCount = 8;
+const int kTransformFlipHorizontally = 1;
+const int kTransformFlipVertically = 2;
+const int kTransformTranspose = 4;
+
+struct CanonicalBoard {
+	PackedBoard board;
+	// transformBoard(original, transform) == board
+	int transform;
+};
+
+PackedBoard transformBoard(PackedBoard board, int transform);
+PackedBoard untransformBoard(PackedBoard board, int transform);
+
+// Movement on the original board -> the same movement on the transformed board.
+UserMovement transformMovement(UserMovement movement, int transform);
+// Movement on the transformed board -> the same movement on the original board.
+UserMovement untransformMovement(UserMovement movement, int transform);
+
+// boards[i] == transformBoard(board, i), but cheaper than 8 separate calls.
+void getSymmetricBoards(PackedBoard board, PackedBoard boards[kBoardTransformCount]);
+
+// The smallest of the 8 symmetric boards, so all of them share one representative.
+CanonicalBoard canonicalizeBoard(PackedBoard board);
+
+// Mixes all 64 bits, usable as a hash table key hash or an index.
+std::uint64_t hashBoard(PackedBoard board);
+// Equal for all symmetric boards.
+std::uint64_t getCanonicalHash(PackedBoard board);
+
+#endif // GAME_2048_SYMMETRY_H
@@ -0,0 +1,228 @@
+#include "telemetry.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Written by one thread only, so a relaxed load and store is enough and avoids
+// the locked instruction of fetch_add. Readers may see a slightly stale value.
+void addRelaxed(std::atomic<std::uint64_t>& counter, std::uint64_t value) {
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+template <int BucketCount>
+struct ShardHistogram {
+	std::atomic<std::uint64_t> buckets[BucketCount];
+	std::atomic<std::uint64_t> count;
+	// in the units of 'sumScale' (moves, nanoseconds)
+	std::atomic<std::uint64_t> sum;
+
+	void add(double value, const double (&bounds)[BucketCount - 1], double sumScale) {
+		int bucket = 0;
+		while (bucket < BucketCount - 1 && value > bounds[bucket]) {
+			bucket++;
+		}
+		addRelaxed(buckets[bucket], 1);
+		addRelaxed(count, 1);
+		addRelaxed(sum, (std::uint64_t)(value * sumScale));
+	}
+
+	void addTo(HistogramSnapshot<BucketCount>& snapshot, double sumScale) const {
+		for (int i = 0; i < BucketCount; i++) {
+			snapshot.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+		}
+		snapshot.count += count.load(std::memory_order_relaxed);
+		snapshot.sum += sum.load(std::memory_order_relaxed) / sumScale;
+	}
+};
+
+const double kLatencySumScale = 1e9;
+
+// Aligned, so shards of different threads never share a cache line.
+struct alignas(64) TelemetryShard {
+	std::atomic<std::uint64_t> moves;
+	std::atomic<std::uint64_t> merges[kTelemetryTileCount];
+	std::atomic<std::uint64_t> spawns[kTelemetryTileCount];
+	std::atomic<std::uint64_t> games;
+	ShardHistogram<kGameLengthBucketCount> gameLengths;
+	ShardHistogram<kMoveLatencyBucketCount> moveLatencies;
+};
+
+struct TelemetryRegistry {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<TelemetryShard>> shards;
+	std::vector<TelemetryShard*> freeShards;
+};
+
+TelemetryRegistry& getRegistry() {
+	// never destroyed, threads may still release their shards during static destruction
+	static TelemetryRegistry* registry = new TelemetryRegistry();
+	return *registry;
+}
+
+// Takes a shard on the first record of a thread and returns it to the registry on thread exit.
+class ShardHolder {
+private:
+	TelemetryShard* shard;
+
+public:
+	ShardHolder() : shard(nullptr) {}
+
+	~ShardHolder() {
+		if (shard != nullptr) {
+			TelemetryRegistry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			registry.freeShards.push_back(shard);
+		}
+	}
+
+	TelemetryShard& get() {
+		if (shard == nullptr) {
+			TelemetryRegistry& registry = getRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+			if (!registry.freeShards.empty()) {
+				shard = registry.freeShards.back();
+				registry.freeShards.pop_back();
+			}
+			else {
+				registry.shards.push_back(std::make_unique<TelemetryShard>());
+				shard = registry.shards.back().get();
+			}
+		}
+		return *shard;
+	}
+};
+
+TelemetryShard& getThreadShard() {
+	thread_local ShardHolder holder;
+	return holder.get();
+}
+
+int getTileIndex(GameTileType tile) {
+	int index = (int)tile;
+	return index < 0 ? 0 : (index >= kTelemetryTileCount ? kTelemetryTileCount - 1 : index);
+}
+
+template <int BucketCount>
+void formatHistogram(std::ostringstream& output, const char* name, const char* help,
+                     const HistogramSnapshot<BucketCount>& histogram, const double (&bounds)[BucketCount - 1]) {
+	output << "# HELP " << name << " " << help << "\n";
+	output << "# TYPE " << name << " histogram\n";
+	std::uint64_t cumulative = 0;
+	for (int i = 0; i < BucketCount; i++) {
+		cumulative += histogram.buckets[i];
+		output << name << "_bucket{le=\"";
+		if (i < BucketCount - 1) {
+			output << bounds[i];
+		}
+		else {
+			output << "+Inf";
+		}
+		output << "\"} " << cumulative << "\n";
+	}
+	output << name << "_sum " << histogram.sum << "\n";
+	output << name << "_count " << histogram.count << "\n";
+}
+
+}
+
+void recordMove() {
+	addRelaxed(getThreadShard().moves, 1);
+}
+
+bool isMoveLatencySampled() {
+	return getThreadShard().moves.load(std::memory_order_relaxed) % kMoveLatencySampleInterval == 0;
+}
+
+void recordMoveLatency(double latencySeconds) {
+	getThreadShard().moveLatencies.add(latencySeconds, kMoveLatencyBuckets, kLatencySumScale);
+}
+
+void recordMerge(GameTileType newTile) {
+	addRelaxed(getThreadShard().merges[getTileIndex(newTile)], 1);
+}
+
+void recordSpawn(GameTileType tile) {
+	addRelaxed(getThreadShard().spawns[getTileIndex(tile)], 1);
+}
+
+void recordGameEnd(int moveCount) {
+	TelemetryShard& shard = getThreadShard();
+	addRelaxed(shard.games, 1);
+	shard.gameLengths.add(moveCount, kGameLengthBuckets, 1.0);
+}
+
+TelemetrySnapshot collectTelemetry() {
+	TelemetrySnapshot snapshot{};
+	TelemetryRegistry& registry = getRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	for (const auto& shard : registry.shards) {
+		snapshot.moves += shard->moves.load(std::memory_order_relaxed);
+		for (int i = 0; i < kTelemetryTileCount; i++) {
+			snapshot.merges[i] += shard->merges[i].load(std::memory_order_relaxed);
+			snapshot.spawns[i] += shard->spawns[i].load(std::memory_order_relaxed);
+		}
+		snapshot.games += shard->games.load(std::memory_order_relaxed);
+		shard->gameLengths.addTo(snapshot.gameLengths, 1.0);
+		shard->moveLatencies.addTo(snapshot.moveLatencies, kLatencySumScale);
+	}
+	snapshot.threadCount = (int)(registry.shards.size() - registry.freeShards.size());
+	return snapshot;
+}
+
+std::string formatTelemetry(const TelemetrySnapshot& snapshot) {
+	std::ostringstream output;
+	output << "# HELP game_2048_moves_total Movements that changed the board.\n";
+	output << "# TYPE game_2048_moves_total counter\n";
+	output << "game_2048_moves_total " << snapshot.moves << "\n";
+	output << "# HELP game_2048_merges_total Merges by the value of the resulting tile.\n";
+	output << "# TYPE game_2048_merges_total counter\n";
+	for (int i = 1; i < kTelemetryTileCount; i++) {
+		if (snapshot.merges[i] != 0) {
+			output << "game_2048_merges_total{tile=\"" << (1 << i) << "\"} " << snapshot.merges[i] << "\n";
+		}
+	}
+	output << "# HELP game_2048_spawns_total Spawned tiles by value.\n";
+	output << "# TYPE game_2048_spawns_total counter\n";
+	for (int i = 1; i < kTelemetryTileCount; i++) {
+		if (snapshot.spawns[i] != 0) {
+			output << "game_2048_spawns_total{tile=\"" << (1 << i) << "\"} " << snapshot.spawns[i] << "\n";
+		}
+	}
+	output << "# HELP game_2048_games_total Finished games.\n";
+	output << "# TYPE game_2048_games_total counter\n";
+	output << "game_2048_games_total " << snapshot.games << "\n";
+	formatHistogram(output, "game_2048_game_length_moves", "Movements per finished game.",
+	                snapshot.gameLengths, kGameLengthBuckets);
+	std::string latencyHelp = "Time of GameField::requestMovement(), one movement in " +
+	                          std::to_string(kMoveLatencySampleInterval) + " per thread.";
+	formatHistogram(output, "game_2048_move_latency_seconds", latencyHelp.c_str(),
+	                snapshot.moveLatencies, kMoveLatencyBuckets);
+	output << "# HELP game_2048_threads Threads that currently record metrics.\n";
+	output << "# TYPE game_2048_threads gauge\n";
+	output << "game_2048_threads " << snapshot.threadCount << "\n";
+	return output.str();
+}
+
+bool writeTelemetry(const std::string& path) {
+	std::string text = formatTelemetry(collectTelemetry());
+	if (path == "-") {
+		std::cout << text << std::flush;
+		return (bool)std::cout;
+	}
+	std::string temporaryPath = path + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		if (!file || !file.write(text.data(), text.size())) {
+			return false;
+		}
+	}
+	return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,61 @@
+#ifndef GAME_2048_TELEMETRY_H
+#define GAME_2048_TELEMETRY_H
+
+#include <cstdint>
+#include <string>
+
+#include "types.h"
+
+/*
+	Engine metrics, recorded by GameField:
+	 - every thread writes only its own shard, with relaxed atomic stores and no locks,
+	   so recording costs a few plain memory writes;
+	 - collectTelemetry() sums all shards on demand, shards of finished threads are kept
+	   (and reused by new threads), so the totals never go down;
+	 - reading the clock costs more than a movement, so only one movement in
+	   kMoveLatencySampleInterval of every thread is timed.
+*/
+
+const int kTelemetryTileCount = 16;
+
+const int kGameLengthBucketCount = 9;
+// Upper bounds of the game length buckets in moves, the last bucket is +Inf.
+const double kGameLengthBuckets[kGameLengthBucketCount - 1] = { 50, 100, 200, 500, 1000, 2000, 5000, 10000 };
+
+const int kMoveLatencyBucketCount = 8;
+// Upper bounds of the move latency buckets in seconds, the last bucket is +Inf.
+const double kMoveLatencyBuckets[kMoveLatencyBucketCount - 1] = { 1e-7, 2.5e-7, 5e-7, 1e-6, 2.5e-6, 1e-5, 1e-4 };
+const int kMoveLatencySampleInterval = 64;
+
+template <int BucketCount>
+struct HistogramSnapshot {
+	std::uint64_t buckets[BucketCount]; // not cumulative
+	std::uint64_t count;
+	double sum;
+};
+
+struct TelemetrySnapshot {
+	std::uint64_t moves;
+	std::uint64_t merges[kTelemetryTileCount]; // by the exponent of the merged tile
+	std::uint64_t spawns[kTelemetryTileCount]; // by the exponent of the spawned tile
+	std::uint64_t games;
+	HistogramSnapshot<kGameLengthBucketCount> gameLengths;
+	HistogramSnapshot<kMoveLatencyBucketCount> moveLatencies; // sampled movements only
+	int threadCount;
+};
+
+void recordMove();
+// True if the next movement of this thread is timed and passed to recordMoveLatency().
+bool isMoveLatencySampled();
+void recordMoveLatency(double latencySeconds);
+void recordMerge(GameTileType newTile);
+void recordSpawn(GameTileType tile);
+void recordGameEnd(int moveCount);
+
+TelemetrySnapshot collectTelemetry();
+// Prometheus text exposition format.
+std::string formatTelemetry(const TelemetrySnapshot& snapshot);
+// "-" writes to stdout. A file is replaced atomically, so a collector never reads a partial one.
+bool writeTelemetry(const std::string& path);
+
+#endif // GAME_2048_TELEMETRY_H
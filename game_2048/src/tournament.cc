@@ -0,0 +1,283 @@
+#include "tournament.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#define COLOR_FIELD        Color{ .r = 160, .g = 160, .b = 160, .a = 255 } // gray
+#define COLOR_FAILED_FIELD Color{ .r = 90, .g = 90, .b = 90, .a = 255 }    // dark gray
+
+namespace {
+
+const float kGridTop = 100;
+const float kGridMargin = 20;
+const int kLabelFontSize = 14;
+
+const int kGridCount = sizeof(kTournamentGameCounts) / sizeof(kTournamentGameCounts[0]);
+
+std::string getGridButtonText(int gameCount) {
+	return "GRID: " + std::to_string(gameCount);
+}
+
+}
+
+TileAtlas::TileAtlas() : texture{}, isLoaded(false) {}
+
+TileAtlas::~TileAtlas() {
+	if (isLoaded) {
+		UnloadRenderTexture(texture);
+	}
+}
+
+Rectangle TileAtlas::getSourceRectangle(int tileIndex) const {
+	float slotSize = kTileSize + 2 * kPadding;
+	float x = (tileIndex % kColumns) * slotSize + kPadding;
+	float y = (tileIndex / kColumns) * slotSize + kPadding;
+	// render textures are stored bottom up, a negative height flips the slot back
+	return Rectangle{
+		.x = x,
+		.y = texture.texture.height - y - kTileSize,
+		.width = kTileSize,
+		.height = -kTileSize,
+	};
+}
+
+void TileAtlas::load(const TileAssets& assets) {
+	int rows = (kTileTypeCount + kColumns - 1) / kColumns;
+	int slotSize = (int)kTileSize + 2 * kPadding;
+	texture = LoadRenderTexture(kColumns * slotSize, rows * slotSize);
+	// boards are drawn smaller than the atlas tiles
+	SetTextureFilter(texture.texture, TEXTURE_FILTER_BILINEAR);
+	isLoaded = true;
+	BeginTextureMode(texture);
+	ClearBackground(BLANK);
+	for (int i = 0; i < kTileTypeCount; i++) {
+		Rectangle slot{
+			.x = (float)((i % kColumns) * slotSize + kPadding),
+			.y = (float)((i / kColumns) * slotSize + kPadding),
+			.width = kTileSize,
+			.height = kTileSize,
+		};
+		DrawRectangleRounded(slot, 0.3f, 5, getTileColor((GameTileType)i));
+		if (!assets.texts[i].empty()) {
+			Vector2 textSize = assets.textSizes[i];
+			DrawText(assets.texts[i].c_str(), (int)(slot.x + (kTileSize - textSize.x) / 2),
+			         (int)(slot.y + (kTileSize - textSize.y) / 2), kFontSize + 8, WHITE);
+		}
+	}
+	EndTextureMode();
+}
+
+void TileAtlas::draw(GameTileType tileType, Rectangle destination) const {
+	int tileIndex = std::clamp((int)tileType, 0, kTileTypeCount - 1);
+	DrawTexturePro(texture.texture, getSourceRectangle(tileIndex), destination, Vector2{}, 0.0f, WHITE);
+}
+
+TournamentGUI::TournamentGUI(const TileAssets& tileAssets) : gridIndex(0), policyStats{},
+	isStopping(false), isPaused(false) {
+	Vector2 backButtonPosition = { .x = 25, .y = 25 };
+	Vector2 backButtonSize = { .x = 200, .y = 50 };
+	backButton.setText("<- BACK");
+	backButton.setPosition(backButtonPosition);
+	backButton.setSize(backButtonSize);
+
+	Vector2 gridButtonSize = { .x = 200, .y = 50 };
+	Vector2 gridButtonPosition = { .x = kWindowWidth - 25 - gridButtonSize.x, .y = 25 };
+	gridButton.setText(getGridButtonText(kTournamentGameCounts[gridIndex]));
+	gridButton.setPosition(gridButtonPosition);
+	gridButton.setSize(gridButtonSize);
+	rootWidget.addChild(&backButton);
+	rootWidget.addChild(&gridButton);
+
+	atlas.load(tileAssets);
+	startGames(kTournamentGameCounts[gridIndex]);
+}
+
+TournamentGUI::~TournamentGUI() {
+	stopGames();
+}
+
+void TournamentGUI::startGames(int gameCount) {
+	games.clear();
+	for (int i = 0; i < gameCount; i++) {
+		auto game = std::make_unique<TournamentGame>();
+		game->policy = i % 2 == 0 ? AIPolicy::Expectimax : AIPolicy::MonteCarlo;
+		game->field.spawnNewTiles();
+		game->board = game->field.getBoard();
+		game->score = 0;
+		game->isFailed = false;
+		games.push_back(std::move(game));
+	}
+	isStopping = false;
+	// one core is left to the GUI thread
+	int workerCount = (int)std::max(2u, std::thread::hardware_concurrency()) - 1;
+	workerCount = std::min(workerCount, gameCount);
+	for (int i = 0; i < workerCount; i++) {
+		workers.emplace_back(&TournamentGUI::workerLoop, this, i, workerCount);
+	}
+}
+
+void TournamentGUI::stopGames() {
+	isStopping = true;
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+}
+
+void TournamentGUI::workerLoop(int worker, int workerCount) {
+	ExpectimaxSearch search;
+	MonteCarloPolicy monteCarlo(kTournamentRolloutsPerMove, 0x2048 + worker);
+	auto restartDelay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(kTournamentRestartDelay));
+	while (!isStopping) {
+		if (isPaused) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			continue;
+		}
+		// a worker owns every workerCount-th game, so no game is shared between threads
+		bool isPlayed = false;
+		auto restartTime = std::chrono::steady_clock::time_point::max();
+		for (std::size_t i = worker; i < games.size() && !isStopping; i += workerCount) {
+			if (playMove(*games[i], search, monteCarlo)) {
+				isPlayed = true;
+			}
+			else {
+				restartTime = std::min(restartTime, games[i]->failedTime + restartDelay);
+			}
+		}
+		// all games of this worker wait for a restart, short sleeps keep stopGames() responsive
+		if (!isPlayed && !isStopping) {
+			std::this_thread::sleep_until(std::min(restartTime,
+				std::chrono::steady_clock::now() + std::chrono::milliseconds(20)));
+		}
+	}
+}
+
+bool TournamentGUI::playMove(TournamentGame& game, ExpectimaxSearch& search, MonteCarloPolicy& monteCarlo) {
+	auto now = std::chrono::steady_clock::now();
+	if (game.isFailed) {
+		if (std::chrono::duration<double>(now - game.failedTime).count() < kTournamentRestartDelay) {
+			return false;
+		}
+		game.field.reset();
+		game.field.spawnNewTiles();
+		game.board = game.field.getBoard();
+		game.score = 0;
+		game.isFailed = false;
+		return true;
+	}
+	PackedBoard board = game.field.getBoard();
+	SearchResult result = game.policy == AIPolicy::MonteCarlo ?
+		monteCarlo.findBestMove(board) : search.findBestMove(board, kTournamentSearchDepth);
+	if (result.bestMovement != UserMovement::None && !game.field.requestMovement(result.bestMovement).empty()) {
+		game.field.spawnNewTiles();
+	}
+	game.board = game.field.getBoard();
+	game.score = game.field.getScore();
+	if (!game.field.isGameFailed()) {
+		return true;
+	}
+	game.failedTime = now;
+	game.isFailed = true;
+	TournamentPolicyStats& stats = policyStats[(int)game.policy];
+	stats.gameCount++;
+	stats.totalScore += game.field.getScore();
+	int maxTile = (int)game.field.getMaxTile();
+	int bestTile = stats.bestTile;
+	while (maxTile > bestTile && !stats.bestTile.compare_exchange_weak(bestTile, maxTile)) {
+	}
+	return true;
+}
+
+void TournamentGUI::drawStats() {
+	const char* policyNames[2] = { "Expectimax", "Monte Carlo" };
+	for (int i = 0; i < 2; i++) {
+		long long gameCount = policyStats[i].gameCount;
+		std::ostringstream statsBuilder;
+		statsBuilder << policyNames[i] << ": " << gameCount << " games";
+		if (gameCount > 0) {
+			int bestTile = policyStats[i].bestTile;
+			statsBuilder << ", avg " << policyStats[i].totalScore / gameCount
+			             << ", best " << (1 << bestTile);
+		}
+		DrawText(statsBuilder.str().c_str(), 250, 28 + i * 24, 20, i == 0 ? DARKGRAY : DARKGREEN);
+	}
+}
+
+void TournamentGUI::draw() {
+	backButton.draw();
+	gridButton.draw();
+	drawStats();
+
+	int gameCount = (int)games.size();
+	int columns = (int)std::ceil(std::sqrt((double)gameCount));
+	int rows = (gameCount + columns - 1) / columns;
+	float cellWidth = (kWindowWidth - 2 * kGridMargin) / columns;
+	float cellHeight = (kWindowHeight - kGridTop - kGridMargin) / rows;
+	// the full size geometry scaled to the cell, minus the label and a small margin
+	float fieldSize = std::min(cellWidth, cellHeight - kLabelFontSize - 4) * 0.95f;
+	float scale = fieldSize / kFieldSize;
+	float tileSize = kTileSize * scale;
+	float gapSize = kGapSize * scale;
+
+	std::vector<Vector2> fieldPositions(gameCount);
+	std::vector<PackedBoard> boards(gameCount);
+	for (int i = 0; i < gameCount; i++) {
+		float cellX = kGridMargin + (i % columns) * cellWidth;
+		float cellY = kGridTop + (i / columns) * cellHeight;
+		fieldPositions[i] = Vector2{
+			.x = cellX + (cellWidth - fieldSize) / 2,
+			.y = cellY + kLabelFontSize + 4,
+		};
+		boards[i] = games[i]->board.load(std::memory_order_relaxed);
+	}
+
+	// 1 - field backgrounds (shapes texture)
+	for (int i = 0; i < gameCount; i++) {
+		Rectangle background{
+			.x = fieldPositions[i].x,
+			.y = fieldPositions[i].y,
+			.width = fieldSize,
+			.height = fieldSize,
+		};
+		Color color = games[i]->isFailed ? COLOR_FAILED_FIELD : COLOR_FIELD;
+		DrawRectangleRounded(background, 0.05f, 4, color);
+	}
+	// 2 - all tiles of all boards (atlas texture)
+	for (int i = 0; i < gameCount; i++) {
+		for (int y = 0; y < 4; y++) {
+			for (int x = 0; x < 4; x++) {
+				Rectangle destination{
+					.x = fieldPositions[i].x + gapSize + (gapSize + tileSize) * x,
+					.y = fieldPositions[i].y + gapSize + (gapSize + tileSize) * y,
+					.width = tileSize,
+					.height = tileSize,
+				};
+				atlas.draw(getBoardTile(boards[i], x, y), destination);
+			}
+		}
+	}
+	// 3 - labels (font texture)
+	for (int i = 0; i < gameCount; i++) {
+		std::ostringstream labelBuilder;
+		labelBuilder << (games[i]->policy == AIPolicy::MonteCarlo ? "MC " : "EX ") << games[i]->score.load();
+		DrawText(labelBuilder.str().c_str(), (int)fieldPositions[i].x,
+		         (int)(fieldPositions[i].y - kLabelFontSize - 2), kLabelFontSize, DARKGRAY);
+	}
+}
+
+void TournamentGUI::process() {
+	if (gridButton.getIsClicked()) {
+		stopGames();
+		gridIndex = (gridIndex + 1) % kGridCount;
+		gridButton.setText(getGridButtonText(kTournamentGameCounts[gridIndex]));
+		startGames(kTournamentGameCounts[gridIndex]);
+	}
+}
+
+void TournamentGUI::update() {}
+
+bool TournamentGUI::isBackButtonClicked() const {
+	return backButton.getIsClicked();
+}
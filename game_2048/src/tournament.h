@@ -0,0 +1,111 @@
+#ifndef GAME_2048_TOURNAMENT_H
+#define GAME_2048_TOURNAMENT_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "window.h"
+#include "logic.h"
+#include "montecarlo.h"
+#include "search.h"
+
+// Grid sizes the tournament view cycles through.
+const int kTournamentGameCounts[] = { 16, 36, 64 };
+// Shallow searches, so every board keeps moving at a watchable pace.
+const int kTournamentSearchDepth = 2;
+const int kTournamentRolloutsPerMove = 64;
+// A finished board stays on screen this long before its game restarts.
+const double kTournamentRestartDelay = 2.0;
+
+/*
+	All tile faces rendered once into one texture. Every tile of every board is then
+	a quad from the same texture, and raylib batches consecutive quads of one texture
+	into a single draw call, no matter how many boards are shown.
+*/
+class TileAtlas {
+private:
+	static const int kColumns = 4;
+	static const int kPadding = 2;
+
+	RenderTexture2D texture;
+	bool isLoaded;
+
+	Rectangle getSourceRectangle(int tileIndex) const;
+
+public:
+	TileAtlas();
+	~TileAtlas();
+
+	TileAtlas(const TileAtlas&) = delete;
+	TileAtlas& operator=(const TileAtlas&) = delete;
+
+	// Needs the window (GL context) to exist.
+	void load(const TileAssets& assets);
+	void draw(GameTileType tileType, Rectangle destination) const;
+};
+
+// Played by a worker thread, the GUI only reads the published atomics.
+struct TournamentGame {
+	GameField field;
+	AIPolicy policy;
+	std::chrono::steady_clock::time_point failedTime;
+
+	std::atomic<PackedBoard> board;
+	std::atomic<int> score;
+	std::atomic<bool> isFailed;
+};
+
+struct TournamentPolicyStats {
+	std::atomic<long long> gameCount;
+	std::atomic<long long> totalScore;
+	std::atomic<int> bestTile;
+};
+
+/*
+	Side by side comparison of the AI policies: boards alternate between expectimax
+	and Monte Carlo, every board has its own GameField, all of them are played on
+	a few worker threads, never on the GUI thread.
+	Boards are drawn in three passes (field backgrounds, tiles from the atlas, labels),
+	so a frame takes a few draw calls instead of several per tile.
+*/
+class TournamentGUI : public IGUIScreen {
+private:
+	Widget rootWidget;
+	Button backButton;
+	Button gridButton;
+
+	TileAtlas atlas;
+
+	int gridIndex;
+	std::vector<std::unique_ptr<TournamentGame>> games;
+	TournamentPolicyStats policyStats[2];
+
+	std::atomic<bool> isStopping;
+	std::atomic<bool> isPaused;
+	std::vector<std::thread> workers;
+
+	void startGames(int gameCount);
+	void stopGames();
+	void workerLoop(int worker, int workerCount);
+	// Returns false if the game is waiting for its restart.
+	bool playMove(TournamentGame& game, ExpectimaxSearch& search, MonteCarloPolicy& monteCarlo);
+	void drawStats();
+
+public:
+	explicit TournamentGUI(const TileAssets& tileAssets);
+	~TournamentGUI();
+
+	virtual void draw();
+	virtual void process();
+	virtual void update();
+	virtual Widget* getRootWidget() { return &rootWidget; }
+
+	bool isBackButtonClicked() const;
+	// Workers sleep while the view is not shown.
+	void setPaused(bool paused) { isPaused = paused; }
+};
+
+#endif // GAME_2048_TOURNAMENT_H
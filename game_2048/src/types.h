@@ -0,0 +1,43 @@
+#ifndef GAME_2048_TYPES_H
+#define GAME_2048_TYPES_H
+
+// Types shared by the game rules, the AI and the GUI. Must not depend on raylib,
+// the headless tools use them too.
+
+enum class GameTileType {
+	NoTile = 0,
+	Tile2,
+	Tile4,
+	Tile8,
+	Tile16,
+	Tile32,
+	Tile64,
+	Tile128,
+	Tile256,
+	Tile512,
+	Tile1024,
+	Tile2048,
+	Tile4096,
+	Tile8192,
+};
+
+enum class UserMovement {
+	None,
+	Left,
+	Right,
+	Up,
+	Down,
+};
+
+enum class AIPolicy {
+	Expectimax = 0,
+	MonteCarlo,
+};
+
+struct TileWithPosition {
+	int x;
+	int y;
+	GameTileType tileType;
+};
+
+#endif // GAME_2048_TYPES_H
@@ -4,40 +4,101 @@
 
 #define FONT_SIZE 40
 
-Button::Button(std::string text, Vector2 position, Vector2 size) :
-	text(text), position(position), size(size), normalColor(RED),
-	hoveredColor(HOVERED_BUTTON_COLOR), isClicked(false), isHovered(false),
-    isCursorChanged(false) {}
-
-void Button::process() {
-    Vector2 mousePosition = GetMousePosition();
-    isHovered = mousePosition.x >= position.x && mousePosition.x <= (position.x + size.x) &&
-        mousePosition.y >= position.y && mousePosition.y <= (position.y + size.y);
-    isClicked = isHovered && IsMouseButtonReleased(MOUSE_BUTTON_LEFT);
-    if (isHovered && !isCursorChanged) {
-        SetMouseCursor(MOUSE_CURSOR_POINTING_HAND);
-        isCursorChanged = true;
-    }
-    if (isClicked || (!isHovered && isCursorChanged)) {
-        SetMouseCursor(MOUSE_CURSOR_DEFAULT);
-        isCursorChanged = false;
+Widget* Widget::hitTest(Vector2 point) {
+    if (!isEnabled) {
+        return nullptr;
+    }
+    bool isGroup = bounds.width <= 0 || bounds.height <= 0;
+    if (!isGroup && !CheckCollisionPointRec(point, bounds)) {
+        return nullptr;
+    }
+    for (auto child = children.rbegin(); child != children.rend(); child++) {
+        Widget* target = (*child)->hitTest(point);
+        if (target != nullptr) {
+            return target;
+        }
+    }
+    return !isGroup && isInteractive() ? this : nullptr;
+}
+
+InputDispatcher::InputDispatcher() : root(nullptr), hoveredWidget(nullptr), pressedWidget(nullptr),
+    clickedWidget(nullptr), mousePosition{}, cursor(MOUSE_CURSOR_DEFAULT), isHitTestNeeded(true) {}
+
+void InputDispatcher::setRoot(Widget* newRoot) {
+    if (root == newRoot) {
+        return;
+    }
+    // the old screen has already seen its click in this frame
+    if (clickedWidget != nullptr) {
+        clickedWidget->onClickExpired();
+        clickedWidget = nullptr;
+    }
+    setHoveredWidget(nullptr);
+    pressedWidget = nullptr;
+    root = newRoot;
+    isHitTestNeeded = true;
+}
+
+void InputDispatcher::setHoveredWidget(Widget* widget) {
+    if (widget == hoveredWidget) {
+        return;
+    }
+    if (hoveredWidget != nullptr) {
+        hoveredWidget->onHoverChanged(false);
     }
+    hoveredWidget = widget;
+    if (hoveredWidget != nullptr) {
+        hoveredWidget->onHoverChanged(true);
+    }
+    int newCursor = hoveredWidget != nullptr ? hoveredWidget->getCursor() : MOUSE_CURSOR_DEFAULT;
+    if (newCursor != cursor) {
+        SetMouseCursor(newCursor);
+        cursor = newCursor;
+    }
+}
+
+void InputDispatcher::dispatch() {
+    if (clickedWidget != nullptr) {
+        clickedWidget->onClickExpired();
+        clickedWidget = nullptr;
+    }
+    Vector2 newMousePosition = GetMousePosition();
+    bool isPressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+    bool isReleased = IsMouseButtonReleased(MOUSE_BUTTON_LEFT);
+    bool isMoved = newMousePosition.x != mousePosition.x || newMousePosition.y != mousePosition.y;
+    if (!isMoved && !isPressed && !isReleased && !isHitTestNeeded) {
+        return;
+    }
+    mousePosition = newMousePosition;
+    isHitTestNeeded = false;
+    setHoveredWidget(root != nullptr ? root->hitTest(mousePosition) : nullptr);
+    if (isPressed) {
+        pressedWidget = hoveredWidget;
+    }
+    if (isReleased) {
+        if (hoveredWidget != nullptr && hoveredWidget == pressedWidget) {
+            hoveredWidget->onClick();
+            clickedWidget = hoveredWidget;
+        }
+        pressedWidget = nullptr;
+    }
+}
+
+Button::Button(std::string text, Vector2 position, Vector2 size) :
+	text(text), normalColor(RED), hoveredColor(HOVERED_BUTTON_COLOR),
+	isClicked(false), isHovered(false) {
+	setPosition(position);
+	setSize(size);
 }
 
 void Button::draw() {
     Vector2 textSize = MeasureTextEx(GetFontDefault(), text.c_str(), FONT_SIZE, 3);
     Vector2 textPosition{
-        .x = (size.x - textSize.x) / 2 + position.x,
-        .y = (size.y - textSize.y) / 2 + position.y,
-    };
-    Rectangle rectangle = {
-        .x = position.x,
-        .y = position.y,
-        .width = size.x,
-        .height = size.y,
+        .x = (bounds.width - textSize.x) / 2 + bounds.x,
+        .y = (bounds.height - textSize.y) / 2 + bounds.y,
     };
     Color color = isHovered ? hoveredColor : normalColor;
-    DrawRectangleRounded(rectangle, 0.3f, 5, color);
+    DrawRectangleRounded(bounds, 0.3f, 5, color);
     DrawText(text.c_str(), (int)textPosition.x, (int)textPosition.y, FONT_SIZE, WHITE);
 }
 
@@ -2,30 +2,98 @@
 #define GAME_2048_WIDGETS_H
 
 #include <string>
+#include <vector>
 
 #include <raylib.h>
 
-class Button {
+/*
+	Every screen owns a tree of widgets, used only for input:
+	 - screens still draw their widgets themselves;
+	 - a widget with empty bounds is a group that covers the whole window,
+	   otherwise its children are only searched inside its bounds;
+	 - children added later are on top and are hit-tested first.
+*/
+class Widget {
 private:
-	std::string text; 
-	Vector2 position; 
-	Vector2 size;
+	std::vector<Widget*> children;
+	bool isEnabled;
+
+protected:
+	Rectangle bounds;
+
+public:
+	Widget() : isEnabled(true), bounds{} {}
+	virtual ~Widget() = default;
+
+	// The child must outlive the tree, usually both are members of one screen.
+	void addChild(Widget* child) { children.push_back(child); }
+	void setEnabled(bool enabled) { isEnabled = enabled; }
+	Rectangle getBounds() const { return bounds; }
+
+	// The topmost interactive widget under the point, or nullptr.
+	Widget* hitTest(Vector2 point);
+
+	virtual bool isInteractive() const { return false; }
+	virtual int getCursor() const { return MOUSE_CURSOR_DEFAULT; }
+	virtual void onHoverChanged(bool /*hovered*/) {}
+	virtual void onClick() {}
+	// The click was visible to the screen for one frame.
+	virtual void onClickExpired() {}
+};
+
+/*
+	Routes the mouse to the widget tree of the current screen once per frame:
+	 - the tree is hit-tested only when the mouse moves, a mouse button changes
+	   state or the tree is replaced, not by every widget in every frame;
+	 - hover changes and clicks go only to the widget under the cursor,
+	   a click needs both the press and the release on the same widget;
+	 - the cursor is set only when the hovered widget asks for a different one.
+*/
+class InputDispatcher {
+private:
+	Widget* root;
+	Widget* hoveredWidget;
+	Widget* pressedWidget;
+	Widget* clickedWidget;
+	Vector2 mousePosition;
+	int cursor;
+	bool isHitTestNeeded;
+
+	void setHoveredWidget(Widget* widget);
+
+public:
+	InputDispatcher();
+
+	void setRoot(Widget* newRoot);
+	// Call when widgets moved or were enabled without a mouse event.
+	void invalidate() { isHitTestNeeded = true; }
+	void dispatch();
+};
+
+class Button : public Widget {
+private:
+	std::string text;
 	Color normalColor;
 	Color hoveredColor;
 	bool isClicked;
 	bool isHovered;
-	bool isCursorChanged;
 
 public:
 	Button(std::string text, Vector2 position, Vector2 size);
 	Button() : Button("", {}, {}) {}
 
 	void setText(std::string text) { this->text = text; }
-	void setPosition(Vector2 position) { this->position = position; }
-	void setSize(Vector2 size) { this->size = size; }
+	void setPosition(Vector2 position) { bounds.x = position.x; bounds.y = position.y; }
+	void setSize(Vector2 size) { bounds.width = size.x; bounds.height = size.y; }
+
+	virtual bool isInteractive() const { return true; }
+	virtual int getCursor() const { return MOUSE_CURSOR_POINTING_HAND; }
+	virtual void onHoverChanged(bool hovered) { isHovered = hovered; }
+	virtual void onClick() { isClicked = true; }
+	virtual void onClickExpired() { isClicked = false; }
 
-	void process();
 	void draw();
+	// True during the frame of the click.
 	bool getIsClicked() const;
 };
 
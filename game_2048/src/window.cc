@@ -1,5 +1,7 @@
 #include "window.h"
 
+#include <cmath>
+
 #define CENTERED_ELEMENT_START(screenWidth, elementWidth) (screenWidth - elementWidth) / 2
 
 #define COLOR(red, green, blue) Color{ .r = red, .g = green, .b = blue, .a = 255 }
@@ -28,9 +30,58 @@ void drawText(std::string text, Vector2 position) {
     DrawText(text.c_str(), (int)position.x, (int)position.y, kFontSize, BLACK);
 }
 
-GameWindow::GameWindow(): currentScreen(nullptr), forcedClose(false) {
-    SetConfigFlags(FLAG_MSAA_4X_HINT);
-    SetTargetFPS(kFramerate);
+std::string getTileText(GameTileType tileType) {
+    switch (tileType) {
+    case GameTileType::Tile2:
+        return "2";
+    case GameTileType::Tile4:
+        return "4";
+    case GameTileType::Tile8:
+        return "8";
+    case GameTileType::Tile16:
+        return "16";
+    case GameTileType::Tile32:
+        return "32";
+    case GameTileType::Tile64:
+        return "64";
+    case GameTileType::Tile128:
+        return "128";
+    case GameTileType::Tile256:
+        return "256";
+    case GameTileType::Tile512:
+        return "512";
+    case GameTileType::Tile1024:
+        return "1024";
+    case GameTileType::Tile2048:
+        return "2048";
+    case GameTileType::Tile4096:
+        return "4096";
+    case GameTileType::Tile8192:
+        return "8192";
+    }
+    return "";
+}
+
+TileAssets prepareTileAssets() {
+    TileAssets assets;
+    for (int i = 0; i < kTileTypeCount; i++) {
+        assets.texts[i] = getTileText((GameTileType)i);
+        assets.textSizes[i] = MeasureTextEx(GetFontDefault(), assets.texts[i].c_str(), kFontSize + 8, 3);
+    }
+    return assets;
+}
+
+GameWindow::GameWindow(const GameSettings& settings): currentScreen(nullptr), forcedClose(false),
+    framerate(settings.framerate), isSimulationOnly(false) {
+    unsigned int flags = 0;
+    if (settings.isMsaaEnabled) {
+        flags |= FLAG_MSAA_4X_HINT;
+    }
+    if (settings.isVsyncEnabled) {
+        flags |= FLAG_VSYNC_HINT;
+    }
+    SetConfigFlags(flags);
+    SetTargetFPS(framerate);
     InitWindow(kWindowWidth, kWindowHeight, "The 2048 Game");
     SetExitKey(KEY_NULL);
 }
@@ -40,11 +91,44 @@ bool GameWindow::shouldBeClosed() const {
 }
 
 void GameWindow::updateLogic() {
+    inputDispatcher.dispatch();
     if (currentScreen != nullptr) {
         currentScreen->process();
     }
 }
 
+void GameWindow::setCurrentScreen(IGUIScreen* screen) {
+    currentScreen = screen;
+    inputDispatcher.setRoot(screen != nullptr ? screen->getRootWidget() : nullptr);
+}
+
+void GameWindow::updateTick() {
+    if (currentScreen != nullptr) {
+        currentScreen->update();
+    }
+}
+
+void GameWindow::setSimulationOnly(bool simulationOnly) {
+    isSimulationOnly = simulationOnly;
+    // In simulation only mode the loop paces itself, so the frame limiter
+    // must not sleep between logic ticks.
+    SetTargetFPS(simulationOnly ? 0 : framerate);
+}
+
+void GameWindow::applySettings(const GameSettings& settings) {
+    framerate = settings.framerate;
+    if (!isSimulationOnly) {
+        SetTargetFPS(framerate);
+    }
+    // the swap interval can be changed on a live window
+    if (settings.isVsyncEnabled) {
+        SetWindowState(FLAG_VSYNC_HINT);
+    }
+    else {
+        ClearWindowState(FLAG_VSYNC_HINT);
+    }
+}
+
 void GameWindow::drawFrame() {
     BeginDrawing();
     ClearBackground(RAYWHITE);
@@ -67,13 +151,18 @@ MainMenuGUI::MainMenuGUI() {
     float buttonLeftOffset = CENTERED_ELEMENT_START(kWindowWidth, buttonSize.x);
 
     Vector2 playButtonPosition = { .x = buttonLeftOffset, .y = 320 };
-    Vector2 settingsButtonPosition = { .x = buttonLeftOffset, .y = playButtonPosition.y + 70 };
+    Vector2 tournamentButtonPosition = { .x = buttonLeftOffset, .y = playButtonPosition.y + 70 };
+    Vector2 settingsButtonPosition = { .x = buttonLeftOffset, .y = tournamentButtonPosition.y + 70 };
     Vector2 exitButtonPosition = { .x = buttonLeftOffset, .y = settingsButtonPosition.y + 70 };
     
     playButton.setText("PLAY");
     playButton.setPosition(playButtonPosition);
     playButton.setSize(buttonSize);
 
+    tournamentButton.setText("TOURNAMENT");
+    tournamentButton.setPosition(tournamentButtonPosition);
+    tournamentButton.setSize(buttonSize);
+
     settingsButton.setText("SETTINGS");
     settingsButton.setPosition(settingsButtonPosition);
     settingsButton.setSize(buttonSize);
@@ -82,26 +171,34 @@ MainMenuGUI::MainMenuGUI() {
     exitButton.setPosition(exitButtonPosition);
     exitButton.setSize(buttonSize);
 
+    rootWidget.addChild(&playButton);
+    rootWidget.addChild(&tournamentButton);
+    rootWidget.addChild(&settingsButton);
+    rootWidget.addChild(&exitButton);
+
     logoTextPosition = { .x = CENTERED_ELEMENT_START(kWindowWidth, getTextSize(logoText).x), .y = 150 };
 }
 
 void MainMenuGUI::draw() {
     drawText(logoText, logoTextPosition);
     playButton.draw();
+    tournamentButton.draw();
     settingsButton.draw();
     exitButton.draw();
 }
 
-void MainMenuGUI::process() {
-    playButton.process();
-    settingsButton.process();
-    exitButton.process();
-}
+void MainMenuGUI::process() {}
+
+void MainMenuGUI::update() {}
 
 bool MainMenuGUI::isPlayButtonClicked() const {
     return playButton.getIsClicked();
 }
 
+bool MainMenuGUI::isTournamentButtonClicked() const {
+    return tournamentButton.getIsClicked();
+}
+
 bool MainMenuGUI::isSettingsButtonClicked() const {
     return settingsButton.getIsClicked();
 }
@@ -110,11 +207,30 @@ bool MainMenuGUI::isExitButtonClicked() const {
     return exitButton.getIsClicked();
 }
 
-SettingsGUI::SettingsGUI() {
+namespace {
+
+// The option after 'value', the first one if 'value' is not an option.
+template <std::size_t OptionCount>
+int getNextOption(const int (&options)[OptionCount], int value) {
+    for (std::size_t i = 0; i < OptionCount; i++) {
+        if (options[i] == value) {
+            return options[(i + 1) % OptionCount];
+        }
+    }
+    return options[0];
+}
+
+std::string getMillisecondsText(int milliseconds, const std::string& zeroText) {
+    return milliseconds == 0 ? zeroText : std::to_string(milliseconds) + " ms";
+}
+
+}
+
+SettingsGUI::SettingsGUI(const GameSettings& settings) : settings(settings), isChangeAsked(false) {
     Vector2 textSize = getTextSize(screenText);
     screenTextPosition = {
         .x = CENTERED_ELEMENT_START(kWindowWidth, textSize.x),
-        .y = CENTERED_ELEMENT_START(kWindowHeight, textSize.y)
+        .y = kWindowHeight - 100
     };
     Vector2 backButtonPosition = { .x = 25, .y = 25 };
     Vector2 backButtonSize = { .x = 200, .y = 50 };
@@ -122,22 +238,77 @@ SettingsGUI::SettingsGUI() {
     backButton.setText("<- BACK");
     backButton.setPosition(backButtonPosition);
     backButton.setSize(backButtonSize);
+    rootWidget.addChild(&backButton);
+
+    Vector2 buttonSize = { .x = 600, .y = 50 };
+    float buttonLeftOffset = CENTERED_ELEMENT_START(kWindowWidth, buttonSize.x);
+    Button* settingButtons[] = { &framerateButton, &vsyncButton, &msaaButton, &animationButton, &aiThinkTimeButton };
+    for (int i = 0; i < 5; i++) {
+        settingButtons[i]->setPosition({ .x = buttonLeftOffset, .y = 200.0f + 80 * i });
+        settingButtons[i]->setSize(buttonSize);
+        rootWidget.addChild(settingButtons[i]);
+    }
+    updateButtonTexts();
+}
+
+void SettingsGUI::updateButtonTexts() {
+    framerateButton.setText("FPS: " + (settings.framerate == 0 ? std::string("NO LIMIT") : std::to_string(settings.framerate)));
+    vsyncButton.setText(std::string("VSYNC: ") + (settings.isVsyncEnabled ? "ON" : "OFF"));
+    msaaButton.setText(std::string("MSAA: ") + (settings.isMsaaEnabled ? "ON" : "OFF"));
+    animationButton.setText("ANIMATION: " + getMillisecondsText(settings.animationDuration, "OFF"));
+    aiThinkTimeButton.setText("AI THINK: " + getMillisecondsText(settings.aiThinkTime, "FIXED DEPTH"));
 }
 
 void SettingsGUI::draw() {
-    drawText(screenText, screenTextPosition);
+    DrawText(screenText.c_str(), (int)screenTextPosition.x, (int)screenTextPosition.y, kFontSize / 2, DARKGRAY);
     backButton.draw();
+    framerateButton.draw();
+    vsyncButton.draw();
+    msaaButton.draw();
+    animationButton.draw();
+    aiThinkTimeButton.draw();
 }
 
 void SettingsGUI::process() {
-    backButton.process();
+    // only one button can be clicked in a frame
+    if (framerateButton.getIsClicked()) {
+        settings.framerate = getNextOption(kFramerateOptions, settings.framerate);
+    }
+    else if (vsyncButton.getIsClicked()) {
+        settings.isVsyncEnabled = !settings.isVsyncEnabled;
+    }
+    else if (msaaButton.getIsClicked()) {
+        settings.isMsaaEnabled = !settings.isMsaaEnabled;
+    }
+    else if (animationButton.getIsClicked()) {
+        settings.animationDuration = getNextOption(kAnimationDurationOptions, settings.animationDuration);
+    }
+    else if (aiThinkTimeButton.getIsClicked()) {
+        settings.aiThinkTime = getNextOption(kAIThinkTimeOptions, settings.aiThinkTime);
+    }
+    else {
+        return;
+    }
+    isChangeAsked = true;
+    updateButtonTexts();
 }
 
+void SettingsGUI::update() {}
+
 bool SettingsGUI::isBackButtonClicked() const {
     return backButton.getIsClicked();
 }
 
-GameGUI::GameGUI() : tiles{}, isGameFailed(false), isResetAsked(false), score(0) {
+bool SettingsGUI::getIsChangeAsked() {
+    bool temp = isChangeAsked;
+    isChangeAsked = false;
+    return temp;
+}
+
+GameGUI::GameGUI(const TileAssets& tileAssets) : tiles{}, isGameFailed(false), isResetAsked(false),
+    isSimulationToggleAsked(false), areAnimationsEnabled(true), animationSteps(0),
+    isAutoplayEnabled(false), autoplayPolicy(AIPolicy::Expectimax), isHintEnabled(false), hints{}, hintDepth(0), score(0),
+    tileAssets(tileAssets) {
     Vector2 backButtonPosition = { .x = 25, .y = 25 };
     Vector2 backButtonSize = { .x = 200, .y = 50 };
     Vector2 resetButtonSize = { .x = 250, .y = 50 };
@@ -154,6 +325,29 @@ GameGUI::GameGUI() : tiles{}, isGameFailed(false), isResetAsked(false), score(0)
     resetButton.setPosition(resetButtonPosition);
     resetButton.setSize(resetButtonSize);
 
+    Vector2 autoplayButtonSize = { .x = 200, .y = 50 };
+    Vector2 autoplayButtonPosition = { 
+        .x = kWindowWidth - 25 - autoplayButtonSize.x,
+        .y = 25
+    };
+    autoplayButton.setText("AI: OFF");
+    autoplayButton.setPosition(autoplayButtonPosition);
+    autoplayButton.setSize(autoplayButtonSize);
+
+    Vector2 hintButtonSize = { .x = 150, .y = 50 };
+    Vector2 hintButtonPosition = {
+        .x = autoplayButtonPosition.x - 20 - hintButtonSize.x,
+        .y = 25
+    };
+    hintButton.setText("HINT");
+    hintButton.setPosition(hintButtonPosition);
+    hintButton.setSize(hintButtonSize);
+
+    rootWidget.addChild(&backButton);
+    rootWidget.addChild(&resetButton);
+    rootWidget.addChild(&autoplayButton);
+    rootWidget.addChild(&hintButton);
+
     Vector2 gameFailedTextSize = MeasureTextEx(GetFontDefault(),
         gameFailedText.c_str(), kFontSize, 3);
     gameFailedTextPosition = {
@@ -168,6 +362,7 @@ GameGUI::GameGUI() : tiles{}, isGameFailed(false), isResetAsked(false), score(0)
         .x = CENTERED_ELEMENT_START(kWindowWidth, kFieldSize),
         .y = CENTERED_ELEMENT_START(kWindowHeight, kFieldSize) - 40,
     };
+    setAnimationDuration(GameSettings{}.animationDuration);
 }
 
 bool GameGUI::getIsResetAsked() {
@@ -176,6 +371,39 @@ bool GameGUI::getIsResetAsked() {
     return temp;
 }
 
+bool GameGUI::getIsSimulationToggleAsked() {
+    bool temp = isSimulationToggleAsked;
+    isSimulationToggleAsked = false;
+    return temp;
+}
+
+void GameGUI::setAnimationsEnabled(bool enabled) {
+    areAnimationsEnabled = enabled;
+    if (!enabled) {
+        finishAnimations();
+    }
+}
+
+void GameGUI::setAnimationDuration(int milliseconds) {
+    animationSteps = (int)std::lround(milliseconds / 1000.0 * kLogicTickRate);
+    if (animationSteps == 0) {
+        finishAnimations();
+    }
+}
+
+void GameGUI::finishAnimations() {
+    for (auto& tileAnimation : animations) {
+        if (tileAnimation.newTile != GameTileType::NoTile) {
+            tiles[tileAnimation.toY][tileAnimation.toX] = tileAnimation.newTile;
+        }
+    }
+    animations.clear();
+    for (auto& pendingTile : pendingTiles) {
+        tiles[pendingTile.y][pendingTile.x] = pendingTile.tileType;
+    }
+    pendingTiles.clear();
+}
+
 void GameGUI::setGameFailed() {
     isGameFailed = true;
 }
@@ -192,6 +420,66 @@ void GameGUI::reset() {
     score = 0;
 }
 
+void GameGUI::setHints(const MovementHint newHints[4], int depth) {
+    for (int i = 0; i < 4; i++) {
+        hints[i] = newHints[i];
+    }
+    hintDepth = depth;
+}
+
+void GameGUI::drawHints() {
+    const int hintFontSize = 20;
+    const char* directionNames[4] = { "LEFT", "RIGHT", "UP", "DOWN" };
+    if (hintDepth == 0) {
+        DrawText("Thinking...", (int)gameFieldPosition.x, 
+                 (int)(gameFieldPosition.y - hintFontSize - 6), hintFontSize, DARKGRAY);
+        return;
+    }
+    int bestHint = -1;
+    for (int i = 0; i < 4; i++) {
+        if (hints[i].isAvailable && (bestHint == -1 || hints[i].value > hints[bestHint].value)) {
+            bestHint = i;
+        }
+    }
+    for (int i = 0; i < 4; i++) {
+        std::ostringstream hintBuilder;
+        hintBuilder << directionNames[i];
+        if (hints[i].isAvailable) {
+            hintBuilder << " +" << (int)hints[i].expectedScore << " " 
+                        << (int)(hints[i].survivalChance * 100) << "%";
+        }
+        else {
+            hintBuilder << " -";
+        }
+        std::string hintText = hintBuilder.str();
+        int textWidth = MeasureText(hintText.c_str(), hintFontSize);
+        Vector2 textPosition{};
+        switch ((UserMovement)(i + 1)) {
+        case UserMovement::Left:
+            textPosition = { .x = gameFieldPosition.x - textWidth - 10, 
+                             .y = gameFieldPosition.y + (kFieldSize - hintFontSize) / 2 };
+            break;
+        case UserMovement::Right:
+            textPosition = { .x = gameFieldPosition.x + kFieldSize + 10,
+                             .y = gameFieldPosition.y + (kFieldSize - hintFontSize) / 2 };
+            break;
+        case UserMovement::Up:
+            textPosition = { .x = gameFieldPosition.x + (kFieldSize - textWidth) / 2,
+                             .y = gameFieldPosition.y - hintFontSize - 6 };
+            break;
+        case UserMovement::Down:
+            textPosition = { .x = gameFieldPosition.x + (kFieldSize - textWidth) / 2,
+                             .y = gameFieldPosition.y + kFieldSize + 6 };
+            break;
+        default:
+            break;
+        }
+        Color hintColor = i == bestHint ? DARKGREEN : DARKGRAY;
+        DrawText(hintText.c_str(), (int)textPosition.x, (int)textPosition.y, 
+                 hintFontSize, hintColor);
+    }
+}
+
 std::string GameGUI::getScoreText() {
     std::ostringstream scoreBuilder;
     scoreBuilder << scoreText << score;
@@ -207,19 +495,20 @@ void GameGUI::drawTile(TileWithAbsolutePosition tile) {
     };
     Color tileColor = getTileColor(tile.tileType);
     DrawRectangleRounded(tileRectangle, 0.3f, 5, tileColor);
-    std::string tileText = getTileText(tile.tileType);
-    if (tileText.size() != 0) {
-        Vector2 textSize = MeasureTextEx(GetFontDefault(),
-            tileText.c_str(), kFontSize + 8, 3);
+    int tileIndex = (int)tile.tileType;
+    if (tileIndex > 0 && tileIndex < kTileTypeCount) {
+        Vector2 textSize = tileAssets.textSizes[tileIndex];
         int textPosX = (kTileSize - textSize.x) / 2 + tileRectangle.x;
         int textPosY = (kTileSize - textSize.y) / 2 + tileRectangle.y;
-        DrawText(tileText.c_str(), textPosX, textPosY, kFontSize + 8, WHITE);
+        DrawText(tileAssets.texts[tileIndex].c_str(), textPosX, textPosY, kFontSize + 8, WHITE);
     }
 }
 
 void GameGUI::draw() {
     backButton.draw();
     resetButton.draw();
+    autoplayButton.draw();
+    hintButton.draw();
     Rectangle mainFieldBackground{
         .x = gameFieldPosition.x,
         .y = gameFieldPosition.y,
@@ -233,6 +522,9 @@ void GameGUI::draw() {
     }
     DrawText(getScoreText().c_str(), (int)scoreTextPosition.x,
         (int)scoreTextPosition.y, kFontSize, BLACK);
+    if (isHintEnabled) {
+        drawHints();
+    }
     if (!isGameFailed) {
         return;
     }
@@ -241,14 +533,39 @@ void GameGUI::draw() {
 }
 
 void GameGUI::process() {
-    backButton.process();
-    resetButton.process();
     if (!isResetAsked && resetButton.getIsClicked()) {
         isResetAsked = true;
     }
+    // OFF -> ON (expectimax) -> MC (Monte Carlo) -> OFF
+    if (autoplayButton.getIsClicked()) {
+        if (!isAutoplayEnabled) {
+            isAutoplayEnabled = true;
+            autoplayPolicy = AIPolicy::Expectimax;
+            autoplayButton.setText("AI: ON");
+        }
+        else if (autoplayPolicy == AIPolicy::Expectimax) {
+            autoplayPolicy = AIPolicy::MonteCarlo;
+            autoplayButton.setText("AI: MC");
+        }
+        else {
+            isAutoplayEnabled = false;
+            autoplayButton.setText("AI: OFF");
+        }
+    }
+    if (hintButton.getIsClicked() || IsKeyPressed(KEY_H)) {
+        isHintEnabled = !isHintEnabled;
+        hintDepth = 0;
+    }
+    if (IsKeyPressed(KEY_F2)) {
+        isSimulationToggleAsked = true;
+    }
+}
+
+void GameGUI::update() {
     for (int i = ((int)animations.size() - 1); i >= 0; i--) {
         auto& tileAnimation = animations[i];
-        if (tileAnimation.currentStep == (kTileAnimationSteps - 1)) {
+        // '>=' - the duration may have been shortened during the animation
+        if (tileAnimation.currentStep >= (animationSteps - 1)) {
             if (tileAnimation.newTile != GameTileType::NoTile) {
                 tiles[tileAnimation.toY][tileAnimation.toX] = 
                     tileAnimation.newTile;
@@ -278,6 +595,10 @@ void GameGUI::setTile(int x, int y, GameTileType tileType) {
     if (x < 0 || x > 3 || y < 0 || y > 3) {
         return;
     }
+    if (!shouldAnimate() && animations.empty()) {
+        tiles[y][x] = tileType;
+        return;
+    }
     pendingTiles.push_back(TileWithPosition{
         .x = x,
         .y = y,
@@ -294,6 +615,13 @@ void GameGUI::moveTile(int fromX, int fromY, int toX, int toY,
     if (tiles[fromY][fromX] == GameTileType::NoTile) {
         return;
     }
+    if (!shouldAnimate()) {
+        tiles[fromY][fromX] = GameTileType::NoTile;
+        if (newTile != GameTileType::NoTile) {
+            tiles[toY][toX] = newTile;
+        }
+        return;
+    }
     animations.push_back(TileMovementAnimation{
         .fromX = fromX,
         .fromY = fromY,
@@ -325,7 +653,7 @@ UserMovement GameGUI::getUserMovement() {
     return UserMovement::None;
 }
 
-Color GameGUI::getTileColor(GameTileType tileType) {
+Color getTileColor(GameTileType tileType) {
     switch (tileType) {
     case GameTileType::Tile2:
         return COLOR_TILE_2;
@@ -357,38 +685,6 @@ Color GameGUI::getTileColor(GameTileType tileType) {
     return COLOR_TILE_EMPTY;
 }
 
-std::string GameGUI::getTileText(GameTileType tileType) {
-    switch (tileType) {
-    case GameTileType::Tile2:
-        return "2";
-    case GameTileType::Tile4:
-        return "4";
-    case GameTileType::Tile8:
-        return "8";
-    case GameTileType::Tile16:
-        return "16";
-    case GameTileType::Tile32:
-        return "32";
-    case GameTileType::Tile64:
-        return "64";
-    case GameTileType::Tile128:
-        return "128";
-    case GameTileType::Tile256:
-        return "256";
-    case GameTileType::Tile512:
-        return "512";
-    case GameTileType::Tile1024:
-        return "1024";
-    case GameTileType::Tile2048:
-        return "2048";
-    case GameTileType::Tile4096:
-        return "4096";
-    case GameTileType::Tile8192:
-        return "8192";
-    }
-    return "";
-}
-
 Vector2 GameGUI::calculateTilePosition(int x, int y) {
     return Vector2{
         .x = gameFieldPosition.x + kGapSize + ((kGapSize + kTileSize) * x),
@@ -420,11 +716,11 @@ std::vector<TileWithAbsolutePosition> GameGUI::getCurrentTiles() {
             .y = tileOldPosition.y,
         };
         if (distanceX >= 1 || distanceX <= -1) {
-            tileCurrentPosition.x += ((distanceX / kTileAnimationSteps) * 
+            tileCurrentPosition.x += ((distanceX / animationSteps) * 
                                       tileAnimation.currentStep);
         }
         if (distanceY >= 1 || distanceY <= -1) {
-            tileCurrentPosition.y += ((distanceY / kTileAnimationSteps) * 
+            tileCurrentPosition.y += ((distanceY / animationSteps) * 
                                       tileAnimation.currentStep);
         }
         tilesToDraw.push_back(TileWithAbsolutePosition{
@@ -8,40 +8,27 @@
 #include <raylib.h>
 
 #include "widgets.h"
+#include "types.h"
+#include "settings.h"
 
 const int kFontSize = 40;
 
 const unsigned int kWindowWidth = 1000;
 const unsigned int kWindowHeight = 900;
 
-const int kFramerate = 144;
-
-const int kTileAnimationSteps = 20;
-
-enum class GameTileType {
-	NoTile = 0,
-	Tile2,
-	Tile4,
-	Tile8,
-	Tile16,
-	Tile32,
-	Tile64,
-	Tile128,
-	Tile256,
-	Tile512,
-	Tile1024,
-	Tile2048,
-	Tile4096,
-	Tile8192,
-};
+// Logic (animations, moves) advances in fixed steps, independent of how
+// often frames are actually rendered.
+const int kLogicTickRate = 144;
+const double kLogicTickDuration = 1.0 / kLogicTickRate;
+// Upper bound of logic steps to catch up on in one rendered frame.
+const int kMaxTicksPerFrame = 8;
+// Render rate used in the "simulation only" mode, where logic is uncapped.
+const int kSimulationRenderRate = 30;
 
-enum class UserMovement {
-	None,
-	Left,
-	Right,
-	Up,
-	Down,
-};
+// Field geometry at full size, smaller views scale all of it.
+const float kTileSize = 128;
+const float kGapSize = 16;
+const float kFieldSize = (kTileSize * 4) + (kGapSize * 5);
 
 struct TileMovementAnimation {
 	int fromX;
@@ -59,25 +46,46 @@ struct TileWithAbsolutePosition {
 	GameTileType tileType;
 };
 
-struct TileWithPosition {
-	int x;
-	int y;
-	GameTileType tileType;
+
+const int kTileTypeCount = (int)GameTileType::Tile8192 + 1;
+
+// Tile labels with their measured sizes. Only the CPU side of the default font
+// is used, so they are prepared on a background thread while the menu is shown.
+struct TileAssets {
+	std::string texts[kTileTypeCount];
+	Vector2 textSizes[kTileTypeCount];
+};
+
+TileAssets prepareTileAssets();
+Color getTileColor(GameTileType tileType);
+
+struct MovementHint {
+	bool isAvailable;
+	float value; // used only to compare the movements
+	float expectedScore; // score expected to be gained within the analysed moves
+	float survivalChance; // chance to still have a movement after the analysed moves
 };
 
 class IGUIScreen {
 public:	
 	virtual void draw() = 0;
+	// Called once per rendered frame, handles user input.
 	virtual void process() = 0;
+	// Called once per fixed logic tick.
+	virtual void update() = 0;
+	// Input of the widgets goes through GameWindow's dispatcher, before process().
+	virtual Widget* getRootWidget() = 0;
 };
 
 class MainMenuGUI : public IGUIScreen {
 private:
+	Widget rootWidget;
 	const std::string logoText = "The 2048 Game";
 
 	Vector2 logoTextPosition;
 
 	Button playButton;
+	Button tournamentButton;
 	Button settingsButton;
 	Button exitButton;
 
@@ -86,34 +94,51 @@ public:
 
 	virtual void draw();
 	virtual void process();
+	virtual void update();
+	virtual Widget* getRootWidget() { return &rootWidget; }
 
 	bool isPlayButtonClicked() const;
+	bool isTournamentButtonClicked() const;
 	bool isSettingsButtonClicked() const;
 	bool isExitButtonClicked() const;
 };
 
 class SettingsGUI : public IGUIScreen {
 private:
-	const std::string screenText = "Currently there are no settings.";
+	Widget rootWidget;
+	const std::string screenText = "Saved to " + kSettingsFile + ", MSAA changes apply after a restart.";
 
 	Vector2 screenTextPosition;
 
 	Button backButton;
+	Button framerateButton;
+	Button vsyncButton;
+	Button msaaButton;
+	Button animationButton;
+	Button aiThinkTimeButton;
+
+	GameSettings settings;
+	bool isChangeAsked;
+
+	void updateButtonTexts();
 
 public:
-	SettingsGUI();
+	explicit SettingsGUI(const GameSettings& settings);
 
 	virtual void draw();
 	virtual void process();
+	virtual void update();
+	virtual Widget* getRootWidget() { return &rootWidget; }
 
 	bool isBackButtonClicked() const;
+	// Returns true once after every change, the new values are in getSettings().
+	bool getIsChangeAsked();
+	const GameSettings& getSettings() const { return settings; }
 };
 
 class GameGUI : public IGUIScreen {
 private:
-	const float kTileSize = 128;
-	const float kGapSize = 16;
-	const float kFieldSize = (kTileSize * 4) + (kGapSize * 5);
+	Widget rootWidget;
 
     const std::string gameFailedText = 
         "You lose :( Press \"RESET\" to try again.";
@@ -121,6 +146,8 @@ private:
 
 	Button backButton;
 	Button resetButton;
+	Button autoplayButton;
+	Button hintButton;
 
 	Vector2 gameFailedTextPosition;
 	Vector2 scoreTextPosition;
@@ -129,6 +156,15 @@ private:
 
     bool isGameFailed;
     bool isResetAsked;
+	bool isSimulationToggleAsked;
+	bool areAnimationsEnabled; // off in the "simulation only" mode
+	int animationSteps; // logic ticks of a tile movement, 0 - no animations
+	bool isAutoplayEnabled;
+	AIPolicy autoplayPolicy;
+	bool isHintEnabled;
+
+	MovementHint hints[4];
+	int hintDepth;
 
 	int score;
 
@@ -136,18 +172,23 @@ private:
 	std::vector<TileMovementAnimation> animations;
 	std::vector<TileWithPosition> pendingTiles;
 
+	TileAssets tileAssets;
+
 	std::string getScoreText();
 	Vector2 calculateTilePosition(int x, int y);
-	Color getTileColor(GameTileType tileType);
-	std::string getTileText(GameTileType tileType);
 	std::vector<TileWithAbsolutePosition> getCurrentTiles();
 	void drawTile(TileWithAbsolutePosition tile);
+	void drawHints();
+	void finishAnimations();
+	bool shouldAnimate() const { return areAnimationsEnabled && animationSteps > 0; }
 
 public:
-	GameGUI();
+	explicit GameGUI(const TileAssets& tileAssets);
 
 	virtual void draw();
 	virtual void process();
+	virtual void update();
+	virtual Widget* getRootWidget() { return &rootWidget; }
 
 	bool isBackButtonClicked() const;
 
@@ -156,6 +197,14 @@ public:
                   GameTileType oldTile, GameTileType newTile);
 	void updateScore(int newScore);
     bool getIsResetAsked();
+	bool getIsSimulationToggleAsked();
+	bool getIsAutoplayEnabled() const { return isAutoplayEnabled; }
+	AIPolicy getAutoplayPolicy() const { return autoplayPolicy; }
+	bool getIsHintEnabled() const { return isHintEnabled; }
+	void setHints(const MovementHint newHints[4], int depth);
+	bool isAnimating() const { return !animations.empty(); }
+	void setAnimationsEnabled(bool enabled);
+	void setAnimationDuration(int milliseconds);
     void setGameFailed();
 	void reset();
     UserMovement getUserMovement();
@@ -164,19 +213,26 @@ public:
 class GameWindow {
 private:
 	IGUIScreen* currentScreen;
+	InputDispatcher inputDispatcher;
 
 	bool forcedClose;
+	int framerate;
+	bool isSimulationOnly;
 
 public:
-	GameWindow();
+	explicit GameWindow(const GameSettings& settings);
 	~GameWindow();
 
 	bool shouldBeClosed() const;
 	void askToClose();
 	void updateLogic();
+	void updateTick();
 	void drawFrame();
+	void setSimulationOnly(bool simulationOnly);
+	// Everything but MSAA, which is only read when the window is created.
+	void applySettings(const GameSettings& settings);
 
-	void setCurrentScreen(IGUIScreen* screen) { currentScreen = screen; }
+	void setCurrentScreen(IGUIScreen* screen);
 };
 
 #endif // GAME_2048_WINDOW_H
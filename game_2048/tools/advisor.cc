@@ -0,0 +1,95 @@
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "advice_server.h"
+#include "logic.h"
+#include "ntuple.h"
+
+using namespace std;
+
+namespace {
+
+AdviceServer* runningServer = nullptr;
+
+void stopServer(int) {
+    if (runningServer != nullptr) {
+        runningServer->stop();
+    }
+}
+
+const char* getMovementName(UserMovement movement) {
+    switch (movement) {
+    case UserMovement::Left: return "left";
+    case UserMovement::Right: return "right";
+    case UserMovement::Up: return "up";
+    case UserMovement::Down: return "down";
+    default: return "none";
+    }
+}
+
+}
+
+// Best move daemon shared by the game instances and tools of one host.
+// Usage:
+//   game_2048_advisor serve [socket path] [threads] [weights file]
+//   game_2048_advisor query <board as 16 hex digits> [socket path] [expectimax | montecarlo] [depth]
+int main(int argc, char** argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "serve") == 0) {
+        string socketPath = argc > 2 ? argv[2] : kAdviceSocketPath;
+        int threadCount = argc > 3 ? atoi(argv[3]) : (int)max(1u, thread::hardware_concurrency());
+        string weightsFile = argc > 4 ? argv[4] : kNTupleWeightsFile;
+
+        // loaded once for all the clients
+        NTupleNetwork network = NTupleNetwork::createDefault();
+        const IBoardEvaluator* evaluator = nullptr;
+        if (network.load(weightsFile)) {
+            network.quantize();
+            evaluator = &network;
+            cout << "Using n-tuple network from " << weightsFile << endl;
+        }
+        AdviceServer server(evaluator, threadCount);
+        if (!server.open(socketPath)) {
+            cerr << "Failed to listen on " << socketPath << endl;
+            return 1;
+        }
+        runningServer = &server;
+        signal(SIGINT, stopServer);
+        signal(SIGTERM, stopServer);
+        cout << "Serving on " << socketPath << " with " << threadCount << " threads" << endl;
+        bool isServed = server.run();
+        runningServer = nullptr;
+        cout << server.getServedCount() << " requests served" << endl;
+        return isServed ? 0 : 1;
+    }
+    if (argc >= 3 && strcmp(argv[1], "query") == 0) {
+        GameField field;
+        field.setBoard(strtoull(argv[2], nullptr, 16));
+        string socketPath = argc > 3 ? argv[3] : kAdviceSocketPath;
+        AIPolicy policy = argc > 4 && strcmp(argv[4], "montecarlo") == 0 ? AIPolicy::MonteCarlo : AIPolicy::Expectimax;
+        AdviceRequest request{
+            .id = 1,
+            .policy = (uint8_t)policy,
+            .depth = (uint8_t)(argc > 5 ? atoi(argv[5]) : 0),
+            .reserved = 0,
+            .board = field.getBoard(),
+        };
+        AdviceClient client;
+        AdviceResponse response;
+        if (!client.connect(socketPath) || !client.requestMoves(&request, &response, 1)) {
+            cerr << "No advice server on " << socketPath << endl;
+            return 1;
+        }
+        cout << getMovementName((UserMovement)response.movement) << " value " << response.value
+             << " nodes " << response.nodeCount << endl;
+        return 0;
+    }
+    cerr << "Usage:" << endl
+         << "  " << argv[0] << " serve [socket path] [threads] [weights file]" << endl
+         << "  " << argv[0] << " query <board as 16 hex digits> [socket path] [expectimax | montecarlo] [depth]" << endl;
+    return 1;
+}
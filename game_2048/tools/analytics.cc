@@ -0,0 +1,121 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "analytics.h"
+#include "search.h"
+#include "self_play.h"
+#include "telemetry.h"
+
+using namespace std;
+
+namespace {
+
+// Plays one GameField game, 'searchDepth' 0 picks random movements.
+void playGame(BoardAnalytics& analytics, ExpectimaxSearch& search, FastRandom& random, int searchDepth) {
+    SelfPlayResult result = playSelfPlayGame(search, random, searchDepth, [&](const SelfPlayMove& move) {
+        analytics.addBoard(move.board);
+    });
+    analytics.addGame(result.maxTile, result.score);
+}
+
+void printBoard(PackedBoard board) {
+    for (int y = 0; y < 4; y++) {
+        cout << "    ";
+        for (int x = 0; x < 4; x++) {
+            int exponent = (int)getBoardTile(board, x, y);
+            cout << setw(6) << (exponent == 0 ? 0 : 1 << exponent);
+        }
+        cout << endl;
+    }
+}
+
+}
+
+// Self-play board statistics in bounded memory, accumulated across runs.
+// Usage: game_2048_analytics <games> [summary file] [threads] [search depth, 0 - random play] [telemetry file, "-" - stdout]
+// The telemetry file is rewritten every second while the games are played, for a Prometheus textfile collector.
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <games> [summary file] [threads] [search depth, 0 - random play]"
+             << " [telemetry file, \"-\" - stdout]" << endl;
+        return 1;
+    }
+    long long gameCount = atoll(argv[1]);
+    string summaryFile = argc > 2 ? argv[2] : "";
+    int threadCount = argc > 3 ? max(1, atoi(argv[3])) : (int)max(1u, thread::hardware_concurrency());
+    int searchDepth = argc > 4 ? atoi(argv[4]) : 0;
+    string telemetryFile = argc > 5 ? argv[5] : "";
+
+    BoardAnalytics total;
+    if (!summaryFile.empty() && total.load(summaryFile)) {
+        cout << "Continuing " << summaryFile << " with " << total.getGameCount() << " games" << endl;
+    }
+    vector<BoardAnalytics> threadAnalytics(threadCount);
+    vector<thread> threads;
+    atomic<int> finishedThreads = 0;
+    for (int t = 0; t < threadCount; t++) {
+        threads.emplace_back([&, t] {
+            ExpectimaxSearch search;
+            FastRandom random(0x2048 + t);
+            for (long long game = t; game < gameCount; game += threadCount) {
+                playGame(threadAnalytics[t], search, random, searchDepth);
+            }
+            finishedThreads++;
+        });
+    }
+    // stdout is left to the final report
+    if (!telemetryFile.empty() && telemetryFile != "-") {
+        auto lastWrite = chrono::steady_clock::now();
+        while (finishedThreads < threadCount) {
+            this_thread::sleep_for(chrono::milliseconds(100));
+            if (chrono::steady_clock::now() - lastWrite >= chrono::seconds(1)) {
+                writeTelemetry(telemetryFile);
+                lastWrite = chrono::steady_clock::now();
+            }
+        }
+    }
+    for (auto& playingThread : threads) {
+        playingThread.join();
+    }
+    for (auto& analytics : threadAnalytics) {
+        total.merge(analytics);
+    }
+    if (!telemetryFile.empty() && !writeTelemetry(telemetryFile)) {
+        cerr << "Failed to write " << telemetryFile << endl;
+    }
+    if (!summaryFile.empty() && !total.save(summaryFile)) {
+        cerr << "Failed to save " << summaryFile << endl;
+        return 1;
+    }
+
+    cout << total.getGameCount() << " games, " << total.getBoardCount() << " boards, ~"
+         << (long long)total.getDistinctBoardCount() << " distinct up to symmetry" << endl;
+    cout << "Max tile:" << endl;
+    const auto& maxTiles = total.getMaxTileHistogram();
+    for (int i = 1; i < (int)maxTiles.size(); i++) {
+        if (maxTiles[i] != 0) {
+            cout << setw(8) << (1 << i) << ": " << maxTiles[i] << endl;
+        }
+    }
+    cout << "Score:" << endl;
+    const auto& scores = total.getScoreHistogram();
+    for (int i = 0; i < (int)scores.size(); i++) {
+        if (scores[i] != 0) {
+            cout << setw(8) << (i == 0 ? 0 : 1 << (i - 1)) << "+: " << scores[i] << endl;
+        }
+    }
+    cout << "Most frequent boards:" << endl;
+    auto heavyHitters = total.getHeavyHitters();
+    for (int i = 0; i < min(10, (int)heavyHitters.size()); i++) {
+        cout << "  ~" << heavyHitters[i].count << " times:" << endl;
+        printBoard(heavyHitters[i].board);
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "ntuple.h"
+#include "opening_book.h"
+
+using namespace std;
+
+// Offline opening book generator.
+// Usage:
+//   game_2048_book build [book file] [search depth] [max ply] [max positions] [threads] [weights file]
+//   game_2048_book query <book file> <board as 16 hex digits>
+int main(int argc, char** argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "build") == 0) {
+        OpeningBookOptions options{
+            .searchDepth = argc > 3 ? atoi(argv[3]) : 5,
+            .maxPly = argc > 4 ? atoi(argv[4]) : 20,
+            .maxPositions = argc > 5 ? (size_t)atoll(argv[5]) : (size_t)1 << 20,
+            .threadCount = argc > 6 ? atoi(argv[6]) : (int)max(1u, thread::hardware_concurrency()),
+            .evaluator = nullptr,
+            .path = argc > 2 ? argv[2] : kOpeningBookFile,
+        };
+        NTupleNetwork network = NTupleNetwork::createDefault();
+        string weightsFile = argc > 7 ? argv[7] : kNTupleWeightsFile;
+        if (network.load(weightsFile)) {
+            network.quantize();
+            options.evaluator = &network;
+            cout << "Using n-tuple network from " << weightsFile << endl;
+        }
+        auto startTime = chrono::steady_clock::now();
+        size_t entryCount = 0;
+        if (!buildOpeningBook(options, &entryCount)) {
+            cerr << "Failed to write " << options.path << endl;
+            return 1;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        cout << entryCount << " positions written to " << options.path << " in " << seconds << " s" << endl;
+        return 0;
+    }
+    if (argc >= 4 && strcmp(argv[1], "query") == 0) {
+        OpeningBook book;
+        if (!book.open(argv[2])) {
+            cerr << "Failed to open " << argv[2] << endl;
+            return 1;
+        }
+        UserMovement movement = UserMovement::None;
+        float value = 0;
+        if (!book.lookup(strtoull(argv[3], nullptr, 16), movement, value)) {
+            cout << "Not in the book" << endl;
+            return 0;
+        }
+        const char* movementNames[] = { "none", "left", "right", "up", "down" };
+        cout << movementNames[(int)movement] << " value " << value << endl;
+        return 0;
+    }
+    cerr << "Usage:" << endl
+         << "  " << argv[0] << " build [book file] [search depth] [max ply] [max positions] [threads] [weights file]" << endl
+         << "  " << argv[0] << " query <book file> <board as 16 hex digits>" << endl;
+    return 1;
+}
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dataset.h"
+#include "search.h"
+#include "self_play.h"
+
+using namespace std;
+
+namespace {
+
+// Plays one GameField game and appends its samples, 'searchDepth' 0 picks random movements.
+void playGame(vector<DatasetSample>& samples, ExpectimaxSearch& search, FastRandom& random, int searchDepth) {
+    size_t firstSample = samples.size();
+    SelfPlayResult result = playSelfPlayGame(search, random, searchDepth, [&](const SelfPlayMove& move) {
+        samples.push_back(DatasetSample{
+            .board = move.board,
+            .movement = move.movement,
+            .reward = (float)move.scoreGained,
+            .outcome = 0,
+        });
+    });
+    // the outcome is only known now
+    for (size_t i = firstSample; i < samples.size(); i++) {
+        samples[i].outcome = result.score;
+    }
+}
+
+}
+
+// Self-play samples in a columnar file for training code.
+// Usage:
+//   game_2048_dataset export <games> <file> [threads] [search depth, 0 - random play] [dedup 0/1] [samples per chunk]
+//   game_2048_dataset stats <file>
+int main(int argc, char** argv)
+{
+    if (argc >= 4 && strcmp(argv[1], "export") == 0) {
+        long long gameCount = atoll(argv[2]);
+        string path = argv[3];
+        int threadCount = argc > 4 ? max(1, atoi(argv[4])) : (int)max(1u, thread::hardware_concurrency());
+        int searchDepth = argc > 5 ? atoi(argv[5]) : 0;
+        bool isDeduplicated = argc > 6 && atoi(argv[6]) != 0;
+        uint32_t chunkSize = argc > 7 ? (uint32_t)atoll(argv[7]) : kDatasetChunkSize;
+
+        DatasetWriter writer;
+        if (!writer.open(path, isDeduplicated, chunkSize)) {
+            cerr << "Failed to create " << path << endl;
+            return 1;
+        }
+        auto startTime = chrono::steady_clock::now();
+        mutex writerMutex;
+        bool isWritten = true;
+        vector<thread> threads;
+        for (int t = 0; t < threadCount; t++) {
+            threads.emplace_back([&, t] {
+                ExpectimaxSearch search;
+                FastRandom random(0x2048 + t);
+                vector<DatasetSample> samples;
+                for (long long game = t; game < gameCount; game += threadCount) {
+                    samples.clear();
+                    playGame(samples, search, random, searchDepth);
+                    lock_guard<mutex> lock(writerMutex);
+                    for (const DatasetSample& sample : samples) {
+                        isWritten = writer.add(sample) && isWritten;
+                    }
+                }
+            });
+        }
+        for (auto& playingThread : threads) {
+            playingThread.join();
+        }
+        if (!writer.close() || !isWritten) {
+            cerr << "Failed to write " << path << endl;
+            return 1;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        cout << writer.getSampleCount() << " samples from " << gameCount << " games written to " << path;
+        if (isDeduplicated) {
+            cout << ", " << writer.getDuplicateCount() << " duplicates skipped";
+        }
+        cout << " in " << seconds << " s" << endl;
+        return 0;
+    }
+    if (argc >= 3 && strcmp(argv[1], "stats") == 0) {
+        DatasetReader reader;
+        if (!reader.open(argv[2])) {
+            cerr << "Failed to open " << argv[2] << endl;
+            return 1;
+        }
+        cout << reader.getSampleCount() << " samples in " << reader.getChunks().size() << " chunks"
+             << (reader.getIsDeduplicated() ? ", deduplicated" : "") << endl;
+        cout << "chunk  samples   left  right     up   down  mean reward  outcome min..max  max tile" << endl;
+        for (size_t i = 0; i < reader.getChunks().size(); i++) {
+            const DatasetChunkHeader& header = *reader.getChunks()[i].header;
+            cout << setw(5) << i << setw(9) << header.sampleCount;
+            for (uint32_t count : header.movementCounts) {
+                cout << setw(7) << count;
+            }
+            cout << fixed << setprecision(2) << setw(13) << header.rewardSum / max(1u, header.sampleCount)
+                 << setw(9) << header.outcomeMin << ".." << left << setw(8) << header.outcomeMax << right
+                 << setw(10) << (1 << header.maxTile) << endl;
+        }
+        return 0;
+    }
+    cerr << "Usage:" << endl
+         << "  " << argv[0] << " export <games> <file> [threads] [search depth, 0 - random play] [dedup 0/1]"
+         << " [samples per chunk]" << endl
+         << "  " << argv[0] << " stats <file>" << endl;
+    return 1;
+}
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "game_host.h"
+#include "ntuple.h"
+
+using namespace std;
+
+namespace {
+
+GameHost* runningHost = nullptr;
+
+void stopHost(int) {
+    if (runningHost != nullptr) {
+        runningHost->stop();
+    }
+}
+
+// Plays 'sessionCount' games at once over one connection, one request per live game per round.
+int runBenchmark(const string& socketPath, int sessionCount, int roundCount, bool isAIPlaying) {
+    GameHostClient client;
+    if (!client.connect(socketPath)) {
+        cerr << "No game host on " << socketPath << endl;
+        return 1;
+    }
+    vector<HostRequest> requests(sessionCount);
+    vector<HostResponse> responses(sessionCount);
+    for (int i = 0; i < sessionCount; i++) {
+        requests[i] = HostRequest{ .id = (uint32_t)i, .command = (uint8_t)HostCommand::Create,
+                                   .argument = 0, .depth = 0, .reserved = 0, .session = 0, .seed = 0 };
+    }
+    if (!client.sendRequests(requests.data(), responses.data(), sessionCount)) {
+        cerr << "Failed to create the sessions" << endl;
+        return 1;
+    }
+    vector<uint32_t> sessions;
+    for (auto& response : responses) {
+        if ((HostStatus)response.status == HostStatus::Ok) {
+            sessions.push_back(response.session);
+        }
+    }
+    cout << sessions.size() << " sessions created" << endl;
+    vector<uint32_t> createdSessions = sessions;
+
+    FastRandom random(0x2048);
+    long long moveCount = 0;
+    int finishedCount = 0;
+    auto startTime = chrono::steady_clock::now();
+    for (int round = 0; round < roundCount && !sessions.empty(); round++) {
+        requests.resize(sessions.size());
+        responses.resize(sessions.size());
+        for (size_t i = 0; i < sessions.size(); i++) {
+            requests[i] = HostRequest{
+                .id = (uint32_t)i,
+                .command = (uint8_t)(isAIPlaying ? HostCommand::AIMove : HostCommand::Move),
+                .argument = (uint8_t)(isAIPlaying ? (int)AIPolicy::Expectimax : (int)(random.next() % 4) + 1),
+                .depth = 1,
+                .reserved = 0,
+                .session = sessions[i],
+                .seed = 0,
+            };
+        }
+        if (!client.sendRequests(requests.data(), responses.data(), (int)requests.size())) {
+            cerr << "Connection lost" << endl;
+            return 1;
+        }
+        vector<uint32_t> liveSessions;
+        for (auto& response : responses) {
+            HostStatus status = (HostStatus)response.status;
+            moveCount += response.movement != (uint8_t)UserMovement::None;
+            if (status == HostStatus::GameOver) {
+                finishedCount++;
+            }
+            else {
+                liveSessions.push_back(response.session);
+            }
+        }
+        sessions.swap(liveSessions);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    cout << moveCount << " moves in " << seconds << " s (" << (long long)(moveCount / seconds) << " moves/s), "
+         << finishedCount << " games finished" << endl;
+
+    // leave the host as it was
+    requests.resize(createdSessions.size());
+    responses.resize(createdSessions.size());
+    for (size_t i = 0; i < createdSessions.size(); i++) {
+        requests[i] = HostRequest{ .id = (uint32_t)i, .command = (uint8_t)HostCommand::Close, .argument = 0,
+                                   .depth = 0, .reserved = 0, .session = createdSessions[i], .seed = 0 };
+    }
+    client.sendRequests(requests.data(), responses.data(), (int)requests.size());
+    return 0;
+}
+
+}
+
+// Headless host of many games for remote players.
+// Usage:
+//   game_2048_host serve [socket path] [threads] [weights file]
+//   game_2048_host bench [socket path] [sessions] [rounds] [random | ai]
+int main(int argc, char** argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "serve") == 0) {
+        string socketPath = argc > 2 ? argv[2] : kHostSocketPath;
+        int threadCount = argc > 3 ? atoi(argv[3]) : (int)max(1u, thread::hardware_concurrency());
+        string weightsFile = argc > 4 ? argv[4] : kNTupleWeightsFile;
+
+        NTupleNetwork network = NTupleNetwork::createDefault();
+        const IBoardEvaluator* evaluator = nullptr;
+        if (network.load(weightsFile)) {
+            network.quantize();
+            evaluator = &network;
+            cout << "Using n-tuple network from " << weightsFile << endl;
+        }
+        GameHost host(evaluator, threadCount);
+        if (!host.open(socketPath)) {
+            cerr << "Failed to listen on " << socketPath << endl;
+            return 1;
+        }
+        runningHost = &host;
+        signal(SIGINT, stopHost);
+        signal(SIGTERM, stopHost);
+        cout << "Hosting on " << socketPath << " with " << threadCount << " search threads" << endl;
+        bool isServed = host.run();
+        runningHost = nullptr;
+        cout << host.getServedCount() << " requests served, " << host.getSessionCount() << " sessions open" << endl;
+        return isServed ? 0 : 1;
+    }
+    if (argc >= 2 && strcmp(argv[1], "bench") == 0) {
+        string socketPath = argc > 2 ? argv[2] : kHostSocketPath;
+        int sessionCount = argc > 3 ? atoi(argv[3]) : 1000;
+        int roundCount = argc > 4 ? atoi(argv[4]) : 100;
+        bool isAIPlaying = argc > 5 && strcmp(argv[5], "ai") == 0;
+        return runBenchmark(socketPath, sessionCount, roundCount, isAIPlaying);
+    }
+    cerr << "Usage:" << endl
+         << "  " << argv[0] << " serve [socket path] [threads] [weights file]" << endl
+         << "  " << argv[0] << " bench [socket path] [sessions] [rounds] [random | ai]" << endl;
+    return 1;
+}
@@ -0,0 +1,75 @@
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "perft.h"
+
+using namespace std;
+
+namespace {
+
+// Tile2 at (0, 0) and (1, 0).
+const PackedBoard kPerftStartBoard = 0x11;
+
+void printLevels(const char* engineName, const vector<PerftLevel>& levels) {
+    cout << engineName << endl
+         << "depth            nodes     distinct    generated         score sum    seconds    nodes/s" << endl;
+    for (const PerftLevel& level : levels) {
+        cout << setw(5) << level.depth << setw(17) << level.nodeCount << setw(13) << level.distinctCount
+             << setw(13) << level.generatedCount << setw(18) << level.scoreSum
+             << fixed << setprecision(3) << setw(11) << level.seconds
+             << setprecision(0) << setw(11) << level.generatedCount / max(level.seconds, 1e-9) << endl;
+    }
+}
+
+}
+
+// Move engine oracle and benchmark: enumerates every movement and spawn to the depth.
+// Usage: game_2048_perft <depth> [board as 16 hex digits] [threads] [table|reference|both]
+// With "both" the exit code is 1 if the engines disagree on any count.
+int main(int argc, char** argv)
+{
+    string engine = argc > 4 ? argv[4] : "table";
+    if (argc < 2 || (engine != "table" && engine != "reference" && engine != "both")) {
+        cerr << "Usage: " << argv[0] << " <depth> [board as 16 hex digits] [threads] [table|reference|both]" << endl;
+        return 1;
+    }
+    PerftOptions options{
+        .board = argc > 2 ? strtoull(argv[2], nullptr, 16) : kPerftStartBoard,
+        .depth = atoi(argv[1]),
+        .threadCount = argc > 3 ? max(1, atoi(argv[3])) : (int)max(1u, thread::hardware_concurrency()),
+        .engine = PerftEngine::Table,
+    };
+    vector<PerftLevel> tableLevels;
+    vector<PerftLevel> referenceLevels;
+    if (engine != "reference") {
+        tableLevels = runPerft(options);
+        printLevels("table", tableLevels);
+    }
+    if (engine != "table") {
+        options.engine = PerftEngine::Reference;
+        referenceLevels = runPerft(options);
+        printLevels("reference", referenceLevels);
+    }
+    if (engine == "both") {
+        bool isMatching = tableLevels.size() == referenceLevels.size();
+        for (size_t i = 0; isMatching && i < tableLevels.size(); i++) {
+            const PerftLevel& a = tableLevels[i];
+            const PerftLevel& b = referenceLevels[i];
+            if (a.nodeCount != b.nodeCount || a.distinctCount != b.distinctCount ||
+                a.generatedCount != b.generatedCount || a.scoreSum != b.scoreSum) {
+                cout << "Mismatch at depth " << a.depth << endl;
+                isMatching = false;
+            }
+        }
+        if (!isMatching) {
+            return 1;
+        }
+        cout << "Engines match" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "solver.h"
+
+using namespace std;
+
+// Exact values of small board variants, ground truth for benchmarking the AI.
+// Usage:
+//   game_2048_solver build <width> <height> <directory> [score | win <target tile>] [threads] [memory MB]
+//   game_2048_solver query <directory> <board as 16 hex digits>
+int main(int argc, char** argv)
+{
+    if (argc >= 5 && strcmp(argv[1], "build") == 0) {
+        SolverOptions options{
+            .width = atoi(argv[2]),
+            .height = atoi(argv[3]),
+            .objective = SolverObjective::Score,
+            .targetTile = GameTileType::Tile2048,
+            .threadCount = (int)max(1u, thread::hardware_concurrency()),
+            .memoryBudget = (size_t)256 << 20,
+            .directory = argv[4],
+        };
+        int nextArgument = 5;
+        if (argc > nextArgument && strcmp(argv[nextArgument], "win") == 0 && argc > nextArgument + 1) {
+            options.objective = SolverObjective::Win;
+            int target = atoi(argv[nextArgument + 1]);
+            int exponent = 0;
+            while ((1 << exponent) < target) {
+                exponent++;
+            }
+            options.targetTile = (GameTileType)exponent;
+            nextArgument += 2;
+        }
+        else if (argc > nextArgument && strcmp(argv[nextArgument], "score") == 0) {
+            nextArgument++;
+        }
+        if (argc > nextArgument) {
+            options.threadCount = max(1, atoi(argv[nextArgument++]));
+        }
+        if (argc > nextArgument) {
+            options.memoryBudget = (size_t)atoi(argv[nextArgument++]) << 20;
+        }
+        auto startTime = chrono::steady_clock::now();
+        SmallBoardSolver solver(options);
+        if (!solver.build()) {
+            cerr << "Build failed" << endl;
+            return 1;
+        }
+        ExactValueTable table;
+        if (!table.open(options.directory)) {
+            cerr << "Failed to open the built table" << endl;
+            return 1;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+        cout << table.getStateCount() << " states solved in " << seconds << " s" << endl;
+        cout << "Start value: " << table.getStartValue() << endl;
+        return 0;
+    }
+    if (argc == 4 && strcmp(argv[1], "query") == 0) {
+        ExactValueTable table;
+        if (!table.open(argv[2])) {
+            cerr << "Failed to open " << argv[2] << endl;
+            return 1;
+        }
+        PackedBoard board = strtoull(argv[3], nullptr, 16);
+        double value = 0;
+        if (!table.lookup(board, value)) {
+            cerr << "Board is not reachable" << endl;
+            return 1;
+        }
+        cout << value << endl;
+        return 0;
+    }
+    cerr << "Usage:" << endl
+         << "  " << argv[0] << " build <width> <height> <directory> [score | win <target tile>] [threads] [memory MB]" << endl
+         << "  " << argv[0] << " query <directory> <board as 16 hex digits>" << endl;
+    return 1;
+}
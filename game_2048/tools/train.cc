@@ -0,0 +1,66 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+#include "ntuple.h"
+
+using namespace std;
+
+// Headless self-play training of the n-tuple network.
+// Usage: game_2048_train <games> [weights file] [learning rate] [--quantize]
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] 
+             << " <games> [weights file] [learning rate] [--quantize]" << endl;
+        return 1;
+    }
+    int gameCount = atoi(argv[1]);
+    string weightsFile = argc > 2 ? argv[2] : kNTupleWeightsFile;
+    float learningRate = argc > 3 ? (float)atof(argv[3]) : 0.1f;
+    bool isQuantizeAsked = argc > 4 && strcmp(argv[4], "--quantize") == 0;
+
+    NTupleNetwork network = NTupleNetwork::createDefault();
+    if (network.load(weightsFile)) {
+        if (network.getIsQuantized()) {
+            cerr << weightsFile << " is quantized and cannot be trained further" << endl;
+            return 1;
+        }
+        cout << "Continuing from " << weightsFile << endl;
+    }
+
+    random_device device;
+    FastRandom random(((uint64_t)device() << 32) | device());
+    const int reportInterval = 1000;
+    long long scoreSum = 0;
+    int reached2048 = 0;
+    int maxScore = 0;
+    for (int game = 1; game <= gameCount; game++) {
+        TrainingGameResult result = playTrainingGame(network, random, learningRate);
+        scoreSum += result.score;
+        maxScore = max(maxScore, result.score);
+        if (result.maxTile >= GameTileType::Tile2048) {
+            reached2048++;
+        }
+        if (game % reportInterval == 0 || game == gameCount) {
+            int gamesInReport = game % reportInterval == 0 ? reportInterval : game % reportInterval;
+            cout << "games " << game << ": average score " << scoreSum / gamesInReport
+                 << ", max score " << maxScore << ", 2048 reached " 
+                 << (100 * reached2048 / gamesInReport) << "%" << endl;
+            scoreSum = 0;
+            reached2048 = 0;
+            maxScore = 0;
+        }
+    }
+
+    if (isQuantizeAsked) {
+        network.quantize();
+    }
+    if (!network.save(weightsFile)) {
+        cerr << "Failed to write " << weightsFile << endl;
+        return 1;
+    }
+    cout << "Weights written to " << weightsFile << endl;
+    return 0;
+}